@@ -0,0 +1,773 @@
+//-----------------------------------------------------------------------------
+// ambiEncoderMockHost.cpp
+// A headless host that drives one or more ambiEncoderProcessor instances with
+// synthetic ProcessData, dense parameter queues and state round trips, and
+// reports throughput, worst-case block time and missed real-time deadlines.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "pluginterfaces/base/funknown.h"
+#include "pluginterfaces/base/ibstream.h"
+#include "pluginterfaces/vst/ivstparameterchanges.h"
+#include "pluginterfaces/vst/ivstmessage.h"
+#include "pluginterfaces/vst/ivsteditcontroller.h"
+#include "pluginterfaces/vst/ivsthostapplication.h"
+#include "../source/ambiEncoderProcessor.h"
+#include "../source/ambiEncoderController.h"
+#include "../source/ambiEncoderIDs.h"
+#include "../source/OrderBudget.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+//-----------------------------------------------------------------------------
+class MockStream: public IBStream {
+public:
+  MockStream(): position(0) {
+    FUNKNOWN_CTOR
+  }
+  virtual ~MockStream() {
+    FUNKNOWN_DTOR
+  }
+  DECLARE_FUNKNOWN_METHODS
+  tresult PLUGIN_API read(void* buffer, int32 numBytes, int32* numBytesRead) SMTG_OVERRIDE {
+    int32 available = (int32) data.size() - (int32) position;
+    int32 count = numBytes < available ? numBytes : available;
+    if (count > 0) {
+      memcpy(buffer, &data[position], count);
+      position += count;
+    }
+    if (numBytesRead) {
+      *numBytesRead = count > 0 ? count : 0;
+    }
+    return count == numBytes ? kResultOk : kResultFalse;
+  }
+  tresult PLUGIN_API write(void* buffer, int32 numBytes, int32* numBytesWritten) SMTG_OVERRIDE {
+    if (position + numBytes > data.size()) {
+      data.resize(position + numBytes);
+    }
+    memcpy(&data[position], buffer, numBytes);
+    position += numBytes;
+    if (numBytesWritten) {
+      *numBytesWritten = numBytes;
+    }
+    return kResultOk;
+  }
+  tresult PLUGIN_API seek(int64 pos, int32 mode, int64* result) SMTG_OVERRIDE {
+    int64 origin = mode == kIBSeekCur ? (int64) position : (mode == kIBSeekEnd ? (int64) data.size() : 0);
+    if (origin + pos < 0) {
+      return kResultFalse;
+    }
+    position = (size_t) (origin + pos);
+    if (result) {
+      *result = position;
+    }
+    return kResultOk;
+  }
+  tresult PLUGIN_API tell(int64* pos) SMTG_OVERRIDE {
+    if (pos) {
+      *pos = position;
+    }
+    return kResultOk;
+  }
+  size_t getSize() {
+    return data.size();
+  }
+  bool hasSameData(const MockStream& other) {
+    return data == other.data;
+  }
+private:
+  std::vector<char> data;
+  size_t position;
+};
+IMPLEMENT_FUNKNOWN_METHODS(MockStream, IBStream, IBStream::iid)
+
+//-----------------------------------------------------------------------------
+class MockParamValueQueue: public IParamValueQueue {
+public:
+  static const int32 MAX_POINTS = 1024;
+  MockParamValueQueue(): parameterId(0), numPoints(0) {
+    FUNKNOWN_CTOR
+  }
+  virtual ~MockParamValueQueue() {
+    FUNKNOWN_DTOR
+  }
+  DECLARE_FUNKNOWN_METHODS
+  void reset(ParamID id) {
+    parameterId = id;
+    numPoints = 0;
+  }
+  ParamID PLUGIN_API getParameterId() SMTG_OVERRIDE {
+    return parameterId;
+  }
+  int32 PLUGIN_API getPointCount() SMTG_OVERRIDE {
+    return numPoints;
+  }
+  tresult PLUGIN_API getPoint(int32 index, int32& sampleOffset, ParamValue& value) SMTG_OVERRIDE {
+    if (index < 0 || index >= numPoints) {
+      return kResultFalse;
+    }
+    sampleOffset = offsets[index];
+    value = values[index];
+    return kResultTrue;
+  }
+  tresult PLUGIN_API addPoint(int32 sampleOffset, ParamValue value, int32& index) SMTG_OVERRIDE {
+    if (numPoints >= MAX_POINTS) {
+      return kResultFalse;
+    }
+    index = numPoints++;
+    offsets[index] = sampleOffset;
+    values[index] = value;
+    return kResultTrue;
+  }
+private:
+  ParamID parameterId;
+  int32 numPoints;
+  int32 offsets[MAX_POINTS];
+  ParamValue values[MAX_POINTS];
+};
+IMPLEMENT_FUNKNOWN_METHODS(MockParamValueQueue, IParamValueQueue, IParamValueQueue::iid)
+
+//-----------------------------------------------------------------------------
+class MockParameterChanges: public IParameterChanges {
+public:
+  static const int32 MAX_QUEUES = 16;
+  MockParameterChanges(): numQueues(0) {
+    FUNKNOWN_CTOR
+  }
+  virtual ~MockParameterChanges() {
+    FUNKNOWN_DTOR
+  }
+  DECLARE_FUNKNOWN_METHODS
+  void clear() {
+    numQueues = 0;
+  }
+  int32 PLUGIN_API getParameterCount() SMTG_OVERRIDE {
+    return numQueues;
+  }
+  IParamValueQueue* PLUGIN_API getParameterData(int32 index) SMTG_OVERRIDE {
+    return index >= 0 && index < numQueues ? &queues[index] : nullptr;
+  }
+  IParamValueQueue* PLUGIN_API addParameterData(const ParamID& id, int32& index) SMTG_OVERRIDE {
+    for (int32 i = 0; i < numQueues; i++) {
+      if (queues[i].getParameterId() == id) {
+        index = i;
+        return &queues[i];
+      }
+    }
+    if (numQueues >= MAX_QUEUES) {
+      return nullptr;
+    }
+    index = numQueues++;
+    queues[index].reset(id);
+    return &queues[index];
+  }
+private:
+  MockParamValueQueue queues[MAX_QUEUES];
+  int32 numQueues;
+};
+IMPLEMENT_FUNKNOWN_METHODS(MockParameterChanges, IParameterChanges, IParameterChanges::iid)
+
+//-----------------------------------------------------------------------------
+class MockAttributeList: public IAttributeList {
+public:
+  MockAttributeList(): intId(nullptr), intValue(0) {
+    FUNKNOWN_CTOR
+  }
+  virtual ~MockAttributeList() {
+    FUNKNOWN_DTOR
+  }
+  DECLARE_FUNKNOWN_METHODS
+  tresult PLUGIN_API setInt(AttrID id, int64 value) SMTG_OVERRIDE {
+    intId = id;
+    intValue = value;
+    return kResultOk;
+  }
+  tresult PLUGIN_API getInt(AttrID id, int64& value) SMTG_OVERRIDE {
+    if (!intId || strcmp(id, intId)) {
+      return kResultFalse;
+    }
+    value = intValue;
+    return kResultOk;
+  }
+  tresult PLUGIN_API setFloat(AttrID, double) SMTG_OVERRIDE {
+    return kNotImplemented;
+  }
+  tresult PLUGIN_API getFloat(AttrID, double&) SMTG_OVERRIDE {
+    return kNotImplemented;
+  }
+  tresult PLUGIN_API setString(AttrID, const TChar*) SMTG_OVERRIDE {
+    return kNotImplemented;
+  }
+  tresult PLUGIN_API getString(AttrID, TChar*, uint32) SMTG_OVERRIDE {
+    return kNotImplemented;
+  }
+  tresult PLUGIN_API setBinary(AttrID, const void*, uint32) SMTG_OVERRIDE {
+    return kNotImplemented;
+  }
+  tresult PLUGIN_API getBinary(AttrID, const void*&, uint32&) SMTG_OVERRIDE {
+    return kNotImplemented;
+  }
+private:
+  AttrID intId;
+  int64 intValue;
+  // I MESSAGGI DEL PLUG-IN PORTANO UN SOLO ATTRIBUTO INTERO...
+};
+IMPLEMENT_FUNKNOWN_METHODS(MockAttributeList, IAttributeList, IAttributeList::iid)
+
+//-----------------------------------------------------------------------------
+class MockMessage: public IMessage {
+public:
+  MockMessage(): messageId(nullptr) {
+    FUNKNOWN_CTOR
+  }
+  virtual ~MockMessage() {
+    FUNKNOWN_DTOR
+  }
+  DECLARE_FUNKNOWN_METHODS
+  FIDString PLUGIN_API getMessageID() SMTG_OVERRIDE {
+    return messageId;
+  }
+  void PLUGIN_API setMessageID(FIDString id) SMTG_OVERRIDE {
+    messageId = id;
+  }
+  IAttributeList* PLUGIN_API getAttributes() SMTG_OVERRIDE {
+    return &attributes;
+  }
+private:
+  FIDString messageId;
+  MockAttributeList attributes;
+};
+IMPLEMENT_FUNKNOWN_METHODS(MockMessage, IMessage, IMessage::iid)
+
+//-----------------------------------------------------------------------------
+class MockHostApplication: public IHostApplication {
+public:
+  MockHostApplication() {
+    FUNKNOWN_CTOR
+  }
+  virtual ~MockHostApplication() {
+    FUNKNOWN_DTOR
+  }
+  DECLARE_FUNKNOWN_METHODS
+  tresult PLUGIN_API getName(String128 name) SMTG_OVERRIDE {
+    const char* hostName = "ambiEncoderMockHost";
+    for (int32 i = 0; i < 128; i++) {
+      name[i] = (char16) hostName[i];
+      if (!hostName[i]) {
+        break;
+      }
+    }
+    return kResultOk;
+  }
+  tresult PLUGIN_API createInstance(TUID cid, TUID _iid, void** obj) SMTG_OVERRIDE {
+    if (FUnknownPrivate::iidEqual(cid, IMessage::iid) && FUnknownPrivate::iidEqual(_iid, IMessage::iid)) {
+      *obj = static_cast<IMessage*>(new MockMessage());
+      return kResultTrue;
+    }
+    *obj = nullptr;
+    return kResultFalse;
+  }
+};
+IMPLEMENT_FUNKNOWN_METHODS(MockHostApplication, IHostApplication, IHostApplication::iid)
+
+//-----------------------------------------------------------------------------
+class MockComponentHandler: public IComponentHandler {
+public:
+  MockComponentHandler(): latencyRestarts(0) {
+    FUNKNOWN_CTOR
+  }
+  virtual ~MockComponentHandler() {
+    FUNKNOWN_DTOR
+  }
+  DECLARE_FUNKNOWN_METHODS
+  tresult PLUGIN_API beginEdit(ParamID) SMTG_OVERRIDE {
+    return kResultOk;
+  }
+  tresult PLUGIN_API performEdit(ParamID, ParamValue) SMTG_OVERRIDE {
+    return kResultOk;
+  }
+  tresult PLUGIN_API endEdit(ParamID) SMTG_OVERRIDE {
+    return kResultOk;
+  }
+  tresult PLUGIN_API restartComponent(int32 flags) SMTG_OVERRIDE {
+    if (flags & kLatencyChanged) {
+      latencyRestarts++;
+    }
+    return kResultOk;
+  }
+  int32 getLatencyRestarts() {
+    return latencyRestarts;
+  }
+private:
+  int32 latencyRestarts;
+};
+IMPLEMENT_FUNKNOWN_METHODS(MockComponentHandler, IComponentHandler, IComponentHandler::iid)
+
+//-----------------------------------------------------------------------------
+struct Options {
+  int32 numInstances;
+  int32 blockSize;
+  double sampleRate;
+  int32 order;
+  double seconds;
+  int32 pointsPerBlock;
+  int32 silenceEvery;
+  int32 stateEvery;
+  int32 budget;
+  bool sceneBus;
+  bool distanceModel;
+  bool nearField;
+  bool reflections;
+  bool strict;
+  bool help;
+};
+
+//-----------------------------------------------------------------------------
+struct Instance {
+  ambiEncoderProcessor* processor;
+  ambiEncoderController* controller;
+  ambiEncoderProcessor* reference;
+  std::vector<std::vector<float> > referenceOutputs;
+  std::vector<float*> referenceOutputPointers;
+  AudioBusBuffers referenceOutputBus;
+  std::vector<float> input;
+  std::vector<std::vector<float> > outputs;
+  std::vector<float*> outputPointers;
+  float* inputPointer;
+  AudioBusBuffers inputBus;
+  AudioBusBuffers outputBus;
+  MockParameterChanges inputChanges;
+  MockParameterChanges outputChanges;
+};
+
+//-----------------------------------------------------------------------------
+static void printUsage(const char* name) {
+  printf("usage: %s [options]\n", name);
+  printf("  -n <instances>     number of processor instances (default 64)\n");
+  printf("  -b <samples>       block size (default 128)\n");
+  printf("  -r <hz>            sample rate (default 48000)\n");
+  printf("  -o <order>         output B-format order, 1 to 3 (default 3)\n");
+  printf("  -s <seconds>       simulated duration (default 10)\n");
+  printf("  -p <points>        parameter points per queue and block (default 8)\n");
+  printf("  -z <blocks>        flag every n-th input block as silent (default 0, never)\n");
+  printf("  -t <blocks>        round trip getState/setState every n-th block (default 0, never)\n");
+  printf("  -l <channels>      process-wide order budget in encoded channels (default $AMBIENCODER_ORDER_BUDGET, or no limit)\n");
+  printf("  -d                 enable the distance model\n");
+  printf("  -f                 enable near-field compensation\n");
+  printf("  -e                 enable the early reflections\n");
+  printf("  -c                 route all instances through the scene bus, the first one collecting,\n");
+  printf("                     setting the roles through connected controllers\n");
+  printf("  -x                 exit with an error if any deadline is missed\n");
+  printf("  -h                 print this help and exit\n");
+}
+
+//-----------------------------------------------------------------------------
+static bool parseOptions(int argc, char* argv[], Options& options) {
+  options.numInstances = 64;
+  options.blockSize = 128;
+  options.sampleRate = 48000.0;
+  options.order = 3;
+  options.seconds = 10.0;
+  options.pointsPerBlock = 8;
+  options.silenceEvery = 0;
+  options.stateEvery = 0;
+  options.budget = 0;
+  options.sceneBus = false;
+  options.distanceModel = false;
+  options.nearField = false;
+  options.reflections = false;
+  options.strict = false;
+  options.help = false;
+  for (int i = 1; i < argc; i++) {
+    const char* option = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(option, "-h")) {
+      options.help = true;
+    } else if (!strcmp(option, "-c")) {
+      options.sceneBus = true;
+    } else if (!strcmp(option, "-d")) {
+      options.distanceModel = true;
+    } else if (!strcmp(option, "-f")) {
+      options.nearField = true;
+    } else if (!strcmp(option, "-e")) {
+      options.reflections = true;
+    } else if (!strcmp(option, "-x")) {
+      options.strict = true;
+    } else if (value && !strcmp(option, "-n")) {
+      options.numInstances = atoi(argv[++i]);
+    } else if (value && !strcmp(option, "-b")) {
+      options.blockSize = atoi(argv[++i]);
+    } else if (value && !strcmp(option, "-r")) {
+      options.sampleRate = atof(argv[++i]);
+    } else if (value && !strcmp(option, "-o")) {
+      options.order = atoi(argv[++i]);
+    } else if (value && !strcmp(option, "-s")) {
+      options.seconds = atof(argv[++i]);
+    } else if (value && !strcmp(option, "-p")) {
+      options.pointsPerBlock = atoi(argv[++i]);
+    } else if (value && !strcmp(option, "-z")) {
+      options.silenceEvery = atoi(argv[++i]);
+    } else if (value && !strcmp(option, "-t")) {
+      options.stateEvery = atoi(argv[++i]);
+    } else if (value && !strcmp(option, "-l")) {
+      options.budget = atoi(argv[++i]);
+    } else {
+      return false;
+    }
+  }
+  return options.numInstances > 0 && options.blockSize > 0 && options.sampleRate > 0.0 &&
+         options.order >= 1 && options.order <= 3 && options.seconds > 0.0 &&
+         options.pointsPerBlock >= 0 && options.pointsPerBlock <= MockParamValueQueue::MAX_POINTS &&
+         options.budget >= 0;
+}
+
+//-----------------------------------------------------------------------------
+static bool roundTripState(ambiEncoderProcessor* processor) {
+  MockStream stream;
+  if (processor->getState(&stream) != kResultOk || stream.getSize() == 0) {
+    return false;
+  }
+  stream.seek(0, IBStream::kIBSeekSet, nullptr);
+  if (processor->setState(&stream) != kResultOk) {
+    return false;
+  }
+  MockStream restored;
+  return processor->getState(&restored) == kResultOk && restored.hasSameData(stream);
+  // LO STATO RICARICATO DEVE ESSERE IDENTICO, BYTE PER BYTE, A QUELLO SALVATO...
+}
+
+//-----------------------------------------------------------------------------
+static void fillParameterChanges(MockParameterChanges& changes, const Options& options, int32 instance, int64 block) {
+  static const ParamID automated[] = {kTheta, kPhi, kDistance, kSpread, kPriority};
+  changes.clear();
+  if (options.pointsPerBlock == 0) {
+    return;
+  }
+  for (uint32 i = 0; i < sizeof(automated) / sizeof(automated[0]); i++) {
+    int32 queueIndex = 0;
+    IParamValueQueue* queue = changes.addParameterData(automated[i], queueIndex);
+    if (!queue) {
+      continue;
+    }
+    for (int32 point = 0; point < options.pointsPerBlock; point++) {
+      int32 offset = (int32) ((int64) point * options.blockSize / options.pointsPerBlock);
+      double time = (block * options.blockSize + offset) / options.sampleRate;
+      double value = 0.5 + 0.5 * sin(2.0 * M_PI * (0.1 + 0.01 * i) * time + instance);
+      int32 pointIndex = 0;
+      queue->addPoint(offset, value, pointIndex);
+    }
+  }
+  // OGNI CODA E' DENSA: options.pointsPerBlock PUNTI PER BLOCCO E PARAMETRO...
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+  if (options.help) {
+    printUsage(argv[0]);
+    return 0;
+  }
+
+  SpeakerArrangement outputArrangements[] = {SpeakerArr::kBFormat1stOrder, SpeakerArr::kBFormat2ndOrder, SpeakerArr::kBFormat3rdOrder};
+  SpeakerArrangement inputArrangement = SpeakerArr::kMono;
+  SpeakerArrangement outputArrangement = outputArrangements[options.order - 1];
+  int32 numOutChannels = SpeakerArr::getChannelCount(outputArrangement);
+
+  ProcessSetup setup;
+  setup.processMode = kRealtime;
+  setup.symbolicSampleSize = kSample32;
+  setup.maxSamplesPerBlock = options.blockSize;
+  setup.sampleRate = options.sampleRate;
+
+  if (options.budget > 0) {
+    OrderBudget::getInstance().setBudget((uint32) options.budget);
+  }
+  // IL BUDGET E' DEL PROCESSO, COME LA VARIABILE D'AMBIENTE: VALE PER TUTTE LE ISTANZE...
+
+  MockHostApplication hostApplication;
+  MockComponentHandler componentHandler;
+  std::vector<Instance> instances(options.numInstances);
+  for (int32 i = 0; i < options.numInstances; i++) {
+    Instance& instance = instances[i];
+    instance.processor = new ambiEncoderProcessor();
+    instance.controller = nullptr;
+    instance.reference = nullptr;
+    instance.input.assign(options.blockSize, 0.0f);
+    instance.outputs.assign(numOutChannels, std::vector<float>(options.blockSize, 0.0f));
+    for (int32 channel = 0; channel < numOutChannels; channel++) {
+      instance.outputPointers.push_back(&instance.outputs[channel][0]);
+    }
+    instance.inputPointer = &instance.input[0];
+    instance.inputBus.numChannels = 1;
+    instance.inputBus.silenceFlags = 0;
+    instance.inputBus.channelBuffers32 = &instance.inputPointer;
+    instance.outputBus.numChannels = numOutChannels;
+    instance.outputBus.silenceFlags = 0;
+    instance.outputBus.channelBuffers32 = &instance.outputPointers[0];
+    if (instance.processor->initialize(nullptr) != kResultOk ||
+        instance.processor->setBusArrangements(&inputArrangement, 1, &outputArrangement, 1) != kResultOk ||
+        instance.processor->setupProcessing(setup) != kResultOk ||
+        !roundTripState(instance.processor) ||
+        instance.processor->setActive(true) != kResultOk) {
+      fprintf(stderr, "instance %d: setup failed\n", i);
+      return 1;
+    }
+    instance.processor->setProcessing(true);
+    if (options.sceneBus) {
+      instance.controller = new ambiEncoderController();
+      if (instance.controller->initialize(&hostApplication) != kResultOk) {
+        fprintf(stderr, "instance %d: controller setup failed\n", i);
+        return 1;
+      }
+      instance.controller->setComponentHandler(&componentHandler);
+      instance.controller->connect(instance.processor);
+      instance.processor->connect(instance.controller);
+      instance.controller->setParamNormalized(kBusMode, (double) (i == 0 ? kBusCollect : kBusSend) / kBusCollect);
+    }
+    // I RUOLI SUL BUS CONDIVISO PASSANO PER IL CONTROLLER, COME QUANDO L'UTENTE LI SCEGLIE DALL'INTERFACCIA...
+    if (options.sceneBus) {
+      instance.reference = new ambiEncoderProcessor();
+      instance.referenceOutputs.assign(numOutChannels, std::vector<float>(options.blockSize, 0.0f));
+      for (int32 channel = 0; channel < numOutChannels; channel++) {
+        instance.referenceOutputPointers.push_back(&instance.referenceOutputs[channel][0]);
+      }
+      instance.referenceOutputBus.numChannels = numOutChannels;
+      instance.referenceOutputBus.silenceFlags = 0;
+      instance.referenceOutputBus.channelBuffers32 = &instance.referenceOutputPointers[0];
+      if (instance.reference->initialize(nullptr) != kResultOk ||
+          instance.reference->setBusArrangements(&inputArrangement, 1, &outputArrangement, 1) != kResultOk ||
+          instance.reference->setupProcessing(setup) != kResultOk ||
+          instance.reference->setActive(true) != kResultOk) {
+        fprintf(stderr, "instance %d: reference setup failed\n", i);
+        return 1;
+      }
+      instance.reference->setProcessing(true);
+    }
+    // UNA COPIA FUORI DAL BUS, CON GLI STESSI INGRESSI, FORNISCE IL SEGNALE CHE OGNI ISTANZA PUBBLICA...
+  }
+  uint32 busLatency = options.sceneBus ? instances[0].processor->getLatencySamples() : 0;
+  int64 controllerFailures = 0;
+  if (options.sceneBus && (busLatency != (uint32) options.blockSize || componentHandler.getLatencyRestarts() != options.numInstances)) {
+    controllerFailures++;
+  }
+  // OGNI CAMBIO DI MODO DEVE RAGGIUNGERE IL PROCESSORE E ANNUNCIARE ALL'HOST LA NUOVA LATENZA...
+
+  std::vector<int32> processingOrder(options.numInstances);
+  for (int32 i = 0; i < options.numInstances; i++) {
+    processingOrder[i] = i;
+  }
+  uint32 shuffleState = 1;
+
+  int64 numBlocks = (int64) (options.seconds * options.sampleRate / options.blockSize);
+  double deadline = options.blockSize / options.sampleRate;
+  double totalTime = 0.0;
+  double worstCycle = 0.0;
+  double worstBlock = 0.0;
+  int64 deadlineMisses = 0;
+  int64 invalidSamples = 0;
+  int64 stateFailures = 0;
+  int64 directErrors = 0;
+  int64 busErrors = 0;
+  bool isDirectPath = !options.sceneBus && !options.distanceModel && !options.reflections;
+  // SUL PERCORSO PREDEFINITO W E' L'INGRESSO PER 1/SQRT(2), QUALUNQUE SIANO DIREZIONE E DIFFUSIONE...
+  bool isBusChecked = options.sceneBus && options.budget == 0;
+  // CON UN BUDGET LE COPIE DI RIFERIMENTO COMPETEREBBERO PER GLI STESSI CANALI...
+  int64 busHistoryLength = (int64) busLatency + options.blockSize;
+  std::vector<std::vector<double> > busHistory(isBusChecked ? numOutChannels : 0, std::vector<double>(busHistoryLength, 0.0));
+  uint32 worstAllocation = 0;
+
+  for (int64 block = 0; block < numBlocks; block++) {
+    bool isSilent = options.silenceEvery > 0 && block % options.silenceEvery == 0;
+    for (int32 i = 0; i < options.numInstances; i++) {
+      Instance& instance = instances[i];
+      for (int32 sample = 0; sample < options.blockSize; sample++) {
+        double time = (block * options.blockSize + sample) / options.sampleRate;
+        instance.input[sample] = isSilent ? 0.0f : (float) (0.25 * sin(2.0 * M_PI * (220.0 + 10.0 * i) * time));
+      }
+      instance.inputBus.silenceFlags = isSilent ? 1 : 0;
+      fillParameterChanges(instance.inputChanges, options, i, block);
+      if (block == 0) {
+        int32 queueIndex = 0;
+        int32 pointIndex = 0;
+        IParamValueQueue* queue = instance.inputChanges.addParameterData(kBypass, queueIndex);
+        if (queue) {
+          queue->addPoint(0, 0.0, pointIndex);
+        }
+        queue = options.distanceModel ? instance.inputChanges.addParameterData(kDistanceModel, queueIndex) : nullptr;
+        if (queue) {
+          queue->addPoint(0, 1.0, pointIndex);
+        }
+        queue = options.nearField ? instance.inputChanges.addParameterData(kNearField, queueIndex) : nullptr;
+        if (queue) {
+          queue->addPoint(0, 1.0, pointIndex);
+        }
+        queue = options.reflections ? instance.inputChanges.addParameterData(kReflections, queueIndex) : nullptr;
+        if (queue) {
+          queue->addPoint(0, 1.0, pointIndex);
+        }
+        // IL PRIMO BLOCCO DISATTIVA IL BYPASS E ATTIVA LE FUNZIONI RICHIESTE...
+      }
+      instance.outputChanges.clear();
+    }
+
+    if (options.sceneBus) {
+      for (int32 i = options.numInstances - 1; i > 0; i--) {
+        shuffleState = shuffleState * 1664525u + 1013904223u;
+        std::swap(processingOrder[i], processingOrder[(shuffleState >> 8) % (uint32) (i + 1)]);
+      }
+    }
+    // CON IL BUS CONDIVISO L'ORDINE DI ELABORAZIONE CAMBIA A OGNI CICLO, COME IN UN HOST MULTI-THREAD...
+    ProcessContext context;
+    memset(&context, 0, sizeof(context));
+    context.state = ProcessContext::kContTimeValid;
+    context.sampleRate = options.sampleRate;
+    context.continuousTimeSamples = block * options.blockSize;
+    auto cycleStart = std::chrono::steady_clock::now();
+    for (int32 k = 0; k < options.numInstances; k++) {
+      Instance& instance = instances[processingOrder[k]];
+      ProcessData data;
+      data.processMode = kRealtime;
+      data.symbolicSampleSize = kSample32;
+      data.numSamples = options.blockSize;
+      data.numInputs = 1;
+      data.numOutputs = 1;
+      data.inputs = &instance.inputBus;
+      data.outputs = &instance.outputBus;
+      data.inputParameterChanges = &instance.inputChanges;
+      data.outputParameterChanges = &instance.outputChanges;
+      data.inputEvents = nullptr;
+      data.outputEvents = nullptr;
+      data.processContext = &context;
+      auto blockStart = std::chrono::steady_clock::now();
+      instance.processor->process(data);
+      double blockTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - blockStart).count();
+      worstBlock = blockTime > worstBlock ? blockTime : worstBlock;
+    }
+    double cycleTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - cycleStart).count();
+    // UN CICLO COMPRENDE TUTTE LE ISTANZE, COME IN UN HOST CHE PROCESSA IN SERIE...
+    uint32 allocation = OrderBudget::getInstance().getAllocatedChannels();
+    worstAllocation = allocation > worstAllocation ? allocation : worstAllocation;
+    for (int32 i = 0; i < options.numInstances && isBusChecked; i++) {
+      Instance& instance = instances[i];
+      ProcessData data;
+      data.processMode = kRealtime;
+      data.symbolicSampleSize = kSample32;
+      data.numSamples = options.blockSize;
+      data.numInputs = 1;
+      data.numOutputs = 1;
+      data.inputs = &instance.inputBus;
+      data.outputs = &instance.referenceOutputBus;
+      data.inputParameterChanges = &instance.inputChanges;
+      data.outputParameterChanges = nullptr;
+      data.inputEvents = nullptr;
+      data.outputEvents = nullptr;
+      data.processContext = &context;
+      instance.reference->process(data);
+    }
+    // LE COPIE DI RIFERIMENTO NON ENTRANO NELLA MISURA DEI TEMPI...
+    totalTime += cycleTime;
+    worstCycle = cycleTime > worstCycle ? cycleTime : worstCycle;
+    if (cycleTime > deadline) {
+      deadlineMisses++;
+    }
+
+    for (int32 i = 0; i < options.numInstances; i++) {
+      Instance& instance = instances[i];
+      for (int32 channel = 0; channel < numOutChannels; channel++) {
+        for (int32 sample = 0; sample < options.blockSize; sample++) {
+          if (!std::isfinite(instance.outputs[channel][sample])) {
+            invalidSamples++;
+          }
+        }
+      }
+      for (int32 sample = 0; sample < options.blockSize && isDirectPath; sample++) {
+        if (fabs(instance.outputs[0][sample] - instance.input[sample] * M_SQRT1_2) > 1e-6) {
+          directErrors++;
+        }
+      }
+      if (options.stateEvery > 0 && block % options.stateEvery == options.stateEvery - 1) {
+        if (!roundTripState(instance.processor)) {
+          stateFailures++;
+        }
+        if (instance.reference && !roundTripState(instance.reference)) {
+          stateFailures++;
+        }
+      }
+    }
+    if (isBusChecked) {
+      for (int32 channel = 0; channel < numOutChannels; channel++) {
+        for (int32 sample = 0; sample < options.blockSize; sample++) {
+          int64 time = block * options.blockSize + sample;
+          double sum = 0.0;
+          for (int32 i = 0; i < options.numInstances; i++) {
+            sum += instances[i].referenceOutputs[channel][sample];
+          }
+          busHistory[channel][time % busHistoryLength] = sum;
+          double expected = time >= (int64) busLatency ? busHistory[channel][(time - busLatency) % busHistoryLength] : 0.0;
+          if (fabs(instances[0].outputs[channel][sample] - expected) > 1e-5 * options.numInstances) {
+            busErrors++;
+          }
+        }
+      }
+    }
+    // IL COLLETTORE DEVE RESTITUIRE LA SOMMA DI TUTTE LE SORGENTI, RITARDATA ESATTAMENTE DELLA LATENZA DICHIARATA...
+  }
+
+  for (int32 i = 0; i < options.numInstances; i++) {
+    if (instances[i].controller) {
+      instances[i].processor->disconnect(instances[i].controller);
+      instances[i].controller->disconnect(instances[i].processor);
+      instances[i].controller->terminate();
+      instances[i].controller->release();
+    }
+    if (instances[i].reference) {
+      instances[i].reference->setProcessing(false);
+      instances[i].reference->setActive(false);
+      instances[i].reference->terminate();
+      instances[i].reference->release();
+    }
+    instances[i].processor->setProcessing(false);
+    instances[i].processor->setActive(false);
+    instances[i].processor->terminate();
+    instances[i].processor->release();
+  }
+
+  double simulatedTime = numBlocks * deadline;
+  printf("instances          %d\n", options.numInstances);
+  printf("block size         %d samples @ %.0f Hz (deadline %.3f ms)\n", options.blockSize, options.sampleRate, deadline * 1000.0);
+  printf("output order       %d (%d channels)\n", options.order, numOutChannels);
+  printf("bus latency        %u samples\n", busLatency);
+  printf("order budget       %u channels (worst allocation %u)\n", OrderBudget::getInstance().getBudget(), worstAllocation);
+  printf("blocks             %lld\n", (long long) numBlocks);
+  printf("realtime factor    %.2fx\n", totalTime > 0.0 ? simulatedTime / totalTime : 0.0);
+  printf("throughput         %.0f instance-samples/s\n", totalTime > 0.0 ? (double) numBlocks * options.blockSize * options.numInstances / totalTime : 0.0);
+  printf("mean cycle         %.3f ms\n", numBlocks > 0 ? totalTime / numBlocks * 1000.0 : 0.0);
+  printf("worst cycle        %.3f ms\n", worstCycle * 1000.0);
+  printf("worst block        %.3f ms\n", worstBlock * 1000.0);
+  printf("deadline misses    %lld\n", (long long) deadlineMisses);
+  printf("invalid samples    %lld\n", (long long) invalidSamples);
+  printf("state failures     %lld\n", (long long) stateFailures);
+  printf("controller errors  %lld\n", (long long) controllerFailures);
+  printf("direct W errors    %lld%s\n", (long long) directErrors, isDirectPath ? "" : " (not checked)");
+  printf("bus sum errors     %lld%s\n", (long long) busErrors, isBusChecked ? "" : " (not checked)");
+
+  if (invalidSamples > 0 || stateFailures > 0 || controllerFailures > 0 || directErrors > 0 || busErrors > 0 || worstAllocation > OrderBudget::getInstance().getBudget()) {
+    return 1;
+  }
+  if (options.strict && deadlineMisses > 0) {
+    return 1;
+  }
+  return 0;
+}
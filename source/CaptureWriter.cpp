@@ -0,0 +1,273 @@
+//-----------------------------------------------------------------------------
+// CaptureWriter.cpp
+// The CaptureWriter class records a multichannel signal to a WAV/RF64 file.
+// The audio thread copies each block into a lock-free single-producer,
+// single-consumer ring; a background thread streams it to disk.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "CaptureWriter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+typedef int int32;
+typedef unsigned int uint32;
+typedef unsigned long long uint64;
+
+static const uint32 ALIGNMENT = 4096;
+// ALLINEAMENTO RICHIESTO DALLE SCRITTURE O_DIRECT...
+
+static void* alignedAlloc(uint32 inputSize) {
+#if defined(_WIN32)
+  return _aligned_malloc(inputSize, ALIGNMENT);
+#else
+  void* pointer = nullptr;
+  if (posix_memalign(&pointer, ALIGNMENT, inputSize) != 0) {
+    return nullptr;
+  }
+  return pointer;
+#endif
+}
+
+static void alignedFree(void* inputPointer) {
+#if defined(_WIN32)
+  _aligned_free(inputPointer);
+#else
+  free(inputPointer);
+#endif
+}
+
+static void putTag(unsigned char* output, const char* inputTag) {
+  memcpy(output, inputTag, 4);
+}
+
+static void putInt16(unsigned char* output, uint32 inputValue) {
+  output[0] = (unsigned char) (inputValue & 0xFF);
+  output[1] = (unsigned char) ((inputValue >> 8) & 0xFF);
+}
+
+static void putInt32(unsigned char* output, uint32 inputValue) {
+  for (uint32 i = 0; i < 4; i++) {
+    output[i] = (unsigned char) ((inputValue >> (8 * i)) & 0xFF);
+  }
+}
+
+static void putInt64(unsigned char* output, uint64 inputValue) {
+  for (uint32 i = 0; i < 8; i++) {
+    output[i] = (unsigned char) ((inputValue >> (8 * i)) & 0xFF);
+  }
+}
+// I CAMPI DEL FORMATO WAV SONO SEMPRE LITTLE ENDIAN...
+
+CaptureWriter::CaptureWriter(uint32 inputNumChannels, double inputSampleRate, double inputRingSeconds):
+                             writeFrames(0), readFrames(0), overruns(0), isRunning(false),
+                             dataBytes(0), fileDescriptor(-1), file(nullptr) {
+  numChannels = inputNumChannels;
+  sampleRate = (uint32) inputSampleRate;
+  ringFrames = CHUNK_FRAMES;
+  while (ringFrames < inputRingSeconds * inputSampleRate) {
+    ringFrames <<= 1;
+  }
+  ringMask = ringFrames - 1;
+  ring = new float*[numChannels];
+  for (uint32 i = 0; i < numChannels; i++) {
+    ring[i] = new float[ringFrames];
+    memset(ring[i], 0, ringFrames * sizeof(float));
+    // TOCCO LA MEMORIA ORA, NON NEL THREAD AUDIO...
+  }
+  chunkSize = CHUNK_FRAMES * numChannels * sizeof(float);
+  chunk = (unsigned char*) alignedAlloc(chunkSize);
+}
+
+CaptureWriter::~CaptureWriter() {
+  stop();
+  for (uint32 i = 0; i < numChannels; i++) {
+    delete[] ring[i];
+  }
+  delete[] ring;
+  alignedFree(chunk);
+}
+
+bool CaptureWriter::start(const char* inputPath) {
+  if (isRunning || !chunk || !openFile(inputPath)) {
+    return false;
+  }
+  dataBytes = 0;
+  writeHeader();
+  isRunning = true;
+  writer = std::thread(&CaptureWriter::run, this);
+  return true;
+}
+
+void CaptureWriter::stop() {
+  if (!isRunning) {
+    return;
+  }
+  isRunning = false;
+  writer.join();
+  // IL THREAD HA GIA' SVUOTATO IL BUFFER, RESTA DA AGGIORNARE L'INTESTAZIONE...
+  writeHeader();
+  closeFile();
+}
+
+bool CaptureWriter::push(float** inputChannels, uint32 numSamples) {
+  uint64 write = writeFrames.load(std::memory_order_relaxed);
+  uint64 read = readFrames.load(std::memory_order_acquire);
+  if (write - read + numSamples > ringFrames) {
+    overruns.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  // IL DISCO NON STA AL PASSO: IL BLOCCO VIENE SCARTATO, SENZA MAI ATTENDERE...
+  uint32 start = (uint32) (write & ringMask);
+  uint32 firstPart = ringFrames - start < numSamples ? ringFrames - start : numSamples;
+  for (uint32 i = 0; i < numChannels; i++) {
+    memcpy(ring[i] + start, inputChannels[i], firstPart * sizeof(float));
+    memcpy(ring[i], inputChannels[i] + firstPart, (numSamples - firstPart) * sizeof(float));
+  }
+  writeFrames.store(write + numSamples, std::memory_order_release);
+  return true;
+}
+
+uint32 CaptureWriter::getOverruns() {
+  return overruns.load(std::memory_order_relaxed);
+}
+
+void CaptureWriter::run() {
+  while (true) {
+    bool isStopping = !isRunning.load(std::memory_order_acquire);
+    uint64 available = writeFrames.load(std::memory_order_acquire) - readFrames.load(std::memory_order_relaxed);
+    if (available >= CHUNK_FRAMES || (isStopping && available > 0)) {
+      writeChunk(available < CHUNK_FRAMES ? (uint32) available : CHUNK_FRAMES);
+      continue;
+    }
+    if (isStopping) {
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+void CaptureWriter::writeChunk(uint32 numFrames) {
+  uint64 read = readFrames.load(std::memory_order_relaxed);
+  float* samples = (float*) chunk;
+  for (uint32 frame = 0; frame < numFrames; frame++) {
+    uint32 index = (uint32) ((read + frame) & ringMask);
+    for (uint32 i = 0; i < numChannels; i++) {
+      samples[frame * numChannels + i] = ring[i][index];
+    }
+  }
+  readFrames.store(read + numFrames, std::memory_order_release);
+  // LO SPAZIO NEL BUFFER CIRCOLARE SI LIBERA PRIMA DELLA SCRITTURA SU DISCO...
+  uint32 size = numFrames * numChannels * sizeof(float);
+  uint32 alignedSize = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  memset(chunk + size, 0, alignedSize - size);
+  writeAt(HEADER_SIZE + dataBytes, chunk, alignedSize);
+  dataBytes += size;
+  // SOLO L'ULTIMO BLOCCO PUO' ESSERE INCOMPLETO, L'ECCEDENZA VIENE TRONCATA ALLA CHIUSURA...
+}
+
+void CaptureWriter::writeHeader() {
+  unsigned char* header = (unsigned char*) alignedAlloc(HEADER_SIZE);
+  if (!header) {
+    return;
+  }
+  memset(header, 0, HEADER_SIZE);
+  uint64 riffSize = HEADER_SIZE - 8 + dataBytes;
+  bool isLarge = riffSize > 0xFFFFFFFFULL;
+  putTag(header, isLarge ? "RF64" : "RIFF");
+  putInt32(header + 4, isLarge ? 0xFFFFFFFF : (uint32) riffSize);
+  putTag(header + 8, "WAVE");
+  putTag(header + 12, isLarge ? "ds64" : "JUNK");
+  putInt32(header + 16, 28);
+  if (isLarge) {
+    putInt64(header + 20, riffSize);
+    putInt64(header + 28, dataBytes);
+    putInt64(header + 36, dataBytes / (numChannels * sizeof(float)));
+  }
+  // IL BLOCCO JUNK RISERVA LO SPAZIO PER ds64, COME PREVISTO DA RF64...
+  putTag(header + 48, "fmt ");
+  putInt32(header + 52, 16);
+  putInt16(header + 56, 3);
+  putInt16(header + 58, numChannels);
+  putInt32(header + 60, sampleRate);
+  putInt32(header + 64, sampleRate * numChannels * sizeof(float));
+  putInt16(header + 68, numChannels * sizeof(float));
+  putInt16(header + 70, 32);
+  putTag(header + 72, "JUNK");
+  putInt32(header + 76, HEADER_SIZE - 88);
+  putTag(header + HEADER_SIZE - 8, "data");
+  putInt32(header + HEADER_SIZE - 4, isLarge ? 0xFFFFFFFF : (uint32) dataBytes);
+  // I DATI INIZIANO A UN OFFSET ALLINEATO...
+  writeAt(0, header, HEADER_SIZE);
+  alignedFree(header);
+}
+
+bool CaptureWriter::openFile(const char* inputPath) {
+#if defined(_WIN32)
+  file = fopen(inputPath, "wb");
+  return file != nullptr;
+#else
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#if defined(O_DIRECT)
+  fileDescriptor = open(inputPath, flags | O_DIRECT, 0644);
+  if (fileDescriptor < 0) {
+    fileDescriptor = open(inputPath, flags, 0644);
+  }
+  // ALCUNI FILE SYSTEM NON SUPPORTANO O_DIRECT...
+#else
+  fileDescriptor = open(inputPath, flags, 0644);
+#endif
+#if defined(F_NOCACHE)
+  if (fileDescriptor >= 0) {
+    fcntl(fileDescriptor, F_NOCACHE, 1);
+  }
+#endif
+  return fileDescriptor >= 0;
+#endif
+}
+
+void CaptureWriter::writeAt(uint64 inputOffset, const void* inputData, uint32 inputSize) {
+#if defined(_WIN32)
+  if (file) {
+    _fseeki64((FILE*) file, inputOffset, SEEK_SET);
+    fwrite(inputData, 1, inputSize, (FILE*) file);
+  }
+#else
+  const unsigned char* data = (const unsigned char*) inputData;
+  while (fileDescriptor >= 0 && inputSize > 0) {
+    ssize_t written = pwrite(fileDescriptor, data, inputSize, inputOffset);
+    if (written <= 0) {
+      return;
+    }
+    data += written;
+    inputOffset += written;
+    inputSize -= (uint32) written;
+  }
+#endif
+}
+
+void CaptureWriter::closeFile() {
+#if defined(_WIN32)
+  if (file) {
+    fclose((FILE*) file);
+    file = nullptr;
+  }
+#else
+  if (fileDescriptor >= 0) {
+    if (ftruncate(fileDescriptor, HEADER_SIZE + dataBytes) != 0) {
+      // IL FILE RESTA VALIDO, CON QUALCHE CAMPIONE NULLO IN CODA...
+    }
+    close(fileDescriptor);
+    fileDescriptor = -1;
+  }
+#endif
+}
@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------------
+// CaptureWriter.h
+// The CaptureWriter class records a multichannel signal to a WAV/RF64 file.
+// The audio thread copies each block into a lock-free single-producer,
+// single-consumer ring; a background thread streams it to disk.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+typedef int int32;
+typedef unsigned int uint32;
+typedef unsigned long long uint64;
+
+class CaptureWriter {
+public:
+  static const uint32 HEADER_SIZE = 4096;
+  static const uint32 CHUNK_FRAMES = 8192;
+  CaptureWriter(uint32 inputNumChannels, double inputSampleRate, double inputRingSeconds);
+  ~CaptureWriter();
+  bool start(const char* inputPath);
+  void stop();
+  bool push(float** inputChannels, uint32 numSamples);
+  uint32 getOverruns();
+private:
+  void run();
+  void writeChunk(uint32 numFrames);
+  void writeHeader();
+  bool openFile(const char* inputPath);
+  void writeAt(uint64 inputOffset, const void* inputData, uint32 inputSize);
+  void closeFile();
+  uint32 numChannels;
+  uint32 sampleRate;
+  float** ring;
+  uint32 ringFrames;
+  uint32 ringMask;
+  std::atomic<uint64> writeFrames;
+  std::atomic<uint64> readFrames;
+  // CONTATORI MONOTONI: LI SCRIVE SOLO IL RISPETTIVO THREAD...
+  std::atomic<uint32> overruns;
+  std::atomic<bool> isRunning;
+  std::thread writer;
+  unsigned char* chunk;
+  uint32 chunkSize;
+  uint64 dataBytes;
+  int32 fileDescriptor;
+  void* file;
+};
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// Decorrelator.cpp
+// The Decorrelator class implements a cascade of Schroeder all-pass filters
+// used to obtain a decorrelated copy of a signal.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "Decorrelator.h"
+#include <cmath>
+
+typedef int int32;
+typedef unsigned int uint32;
+
+static const uint32 STAGE_LENGTHS[Decorrelator::NUM_VARIANTS][Decorrelator::NUM_STAGES] = {
+  {101, 211, 307},
+  {149, 263, 353},
+  {179, 233, 331},
+  {103, 223, 311},
+  {107, 227, 313},
+  {109, 229, 317},
+  {113, 239, 337},
+  {127, 241, 347},
+  {131, 251, 349},
+  {137, 257, 359},
+  {139, 269, 367},
+  {151, 271, 373},
+  {157, 277, 379},
+  {163, 281, 383},
+  {167, 283, 389}
+};
+// LUNGHEZZE PRIME, DIVERSE PER OGNI VARIANTE (UNA PER CANALE DIREZIONALE), ONDE EVITARE CORRELAZIONI TRA LE USCITE...
+
+Decorrelator::Decorrelator(uint32 inputVariant): GAIN(0.5) {
+  buffers = new double*[NUM_STAGES];
+  for (uint32 i = 0; i < NUM_STAGES; i++) {
+    lengths[i] = STAGE_LENGTHS[inputVariant % NUM_VARIANTS][i];
+    buffers[i] = new double[lengths[i]];
+  }
+  direct = 1.0;
+  for (uint32 i = 0; i < NUM_STAGES; i++) {
+    direct *= -GAIN;
+  }
+  normalization = 1.0 / sqrt(1.0 - direct * direct);
+  clear();
+}
+
+Decorrelator::~Decorrelator() {
+  for (uint32 i = 0; i < NUM_STAGES; i++) {
+    delete[] buffers[i];
+  }
+  delete[] buffers;
+}
+
+void Decorrelator::clear() {
+  for (uint32 i = 0; i < NUM_STAGES; i++) {
+    for (uint32 j = 0; j < lengths[i]; j++) {
+      buffers[i][j] = 0.0;
+    }
+    indexes[i] = 0;
+  }
+}
+
+double Decorrelator::oneSampleProcessor(double inputSample) {
+  double sample = inputSample;
+  for (uint32 i = 0; i < NUM_STAGES; i++) {
+    double delayed = buffers[i][indexes[i]];
+    double output = delayed - GAIN * sample;
+    buffers[i][indexes[i]] = sample + GAIN * output;
+    indexes[i] = indexes[i] + 1 < lengths[i] ? indexes[i] + 1 : 0;
+    sample = output;
+  }
+  return (sample - direct * inputSample) * normalization;
+  // LA CASCATA LASCIA PASSARE (-GAIN)^N DEL SEGNALE SENZA RITARDO: TOLTO QUESTO TERMINE L'USCITA NON E' PIU' CORRELATA ALL'INGRESSO...
+}
@@ -0,0 +1,28 @@
+//-----------------------------------------------------------------------------
+// Decorrelator.h
+// The Decorrelator class implements a cascade of Schroeder all-pass filters
+// used to obtain a decorrelated copy of a signal.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+typedef int int32;
+typedef unsigned int uint32;
+
+class Decorrelator {
+public:
+  static const uint32 NUM_STAGES = 3;
+  static const uint32 NUM_VARIANTS = 15;
+  Decorrelator(uint32 inputVariant);
+  ~Decorrelator();
+  void clear();
+  double oneSampleProcessor(double inputSample);
+private:
+  double** buffers;
+  uint32 lengths[NUM_STAGES];
+  uint32 indexes[NUM_STAGES];
+  double direct;
+  double normalization;
+  const double GAIN;
+};
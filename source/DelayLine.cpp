@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------------------
+// DelayLine.cpp
+// The DelayLine class implements a circular delay line with fractional,
+// per-sample delay times and 3rd order Lagrange interpolation.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "DelayLine.h"
+
+typedef int int32;
+typedef unsigned int uint32;
+
+DelayLine::DelayLine(uint32 inputMaxDelay, uint32 inputMaxBlockSize): writeIndex(0), blockStart(0) {
+  bufferLength = 1;
+  while (bufferLength < inputMaxDelay + inputMaxBlockSize + 4) {
+    bufferLength <<= 1;
+  }
+  // UNA LUNGHEZZA 2^N PERMETTE DI AVVOLGERE GLI INDICI CON UNA MASCHERA...
+  bufferMask = bufferLength - 1;
+  buffer = new float[bufferLength];
+  maxDelay = inputMaxDelay;
+  clear();
+}
+
+DelayLine::~DelayLine() {
+  delete[] buffer;
+}
+
+void DelayLine::clear() {
+  for (uint32 i = 0; i < bufferLength; i++) {
+    buffer[i] = 0.0f;
+  }
+  writeIndex = 0;
+  blockStart = 0;
+}
+
+void DelayLine::write(const float* inputBlock, uint32 numSamples) {
+  blockStart = writeIndex;
+  for (uint32 i = 0; i < numSamples; i++) {
+    buffer[(writeIndex + i) & bufferMask] = inputBlock[i];
+  }
+  writeIndex = (writeIndex + numSamples) & bufferMask;
+}
+
+void DelayLine::read(const double* inputDelays, double* outputBlock, uint32 numSamples) {
+  // LEGGE IL BLOCCO SCRITTO PER ULTIMO; IL CICLO NON HA SALTI CONDIZIONALI, COSI' PUO' ESSERE VETTORIZZATO...
+  const double origin = (double) blockStart + bufferLength;
+  for (uint32 i = 0; i < numSamples; i++) {
+    double delay = inputDelays[i];
+    delay = delay < MIN_DELAY ? MIN_DELAY : delay;
+    delay = delay > maxDelay ? maxDelay : delay;
+    double position = origin + i - delay;
+    uint32 index = (uint32) position;
+    double fraction = position - index;
+    double xm1 = buffer[(index - 1) & bufferMask];
+    double x0 = buffer[index & bufferMask];
+    double x1 = buffer[(index + 1) & bufferMask];
+    double x2 = buffer[(index + 2) & bufferMask];
+    double dp1 = fraction + 1.0;
+    double dm1 = fraction - 1.0;
+    double dm2 = fraction - 2.0;
+    outputBlock[i] = -xm1 * fraction * dm1 * dm2 * (1.0 / 6.0)
+                     + x0 * dp1 * dm1 * dm2 * 0.5
+                     - x1 * dp1 * fraction * dm2 * 0.5
+                     + x2 * dp1 * fraction * dm1 * (1.0 / 6.0);
+  }
+}
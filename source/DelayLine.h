@@ -0,0 +1,28 @@
+//-----------------------------------------------------------------------------
+// DelayLine.h
+// The DelayLine class implements a circular delay line with fractional,
+// per-sample delay times and 3rd order Lagrange interpolation.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+typedef int int32;
+typedef unsigned int uint32;
+
+class DelayLine {
+public:
+  static const uint32 MIN_DELAY = 2;
+  DelayLine(uint32 inputMaxDelay, uint32 inputMaxBlockSize);
+  ~DelayLine();
+  void clear();
+  void write(const float* inputBlock, uint32 numSamples);
+  void read(const double* inputDelays, double* outputBlock, uint32 numSamples);
+private:
+  float* buffer;
+  uint32 bufferLength;
+  uint32 bufferMask;
+  uint32 writeIndex;
+  uint32 blockStart;
+  double maxDelay;
+};
@@ -1,7 +1,7 @@
 //-----------------------------------------------------------------------------
 // Encoder.cpp
-// The Encoder class implements a 3rd order ambisonic encoder with FuMa
-// channel ordering and MaxN normalization coefficients.
+// The Encoder class implements a 1st, 2nd or 3rd order ambisonic encoder
+// with FuMa channel ordering and MaxN normalization coefficients.
 // © 2017, Rodolfo Cangiotti. Some rights reserved.
 //-----------------------------------------------------------------------------
 
@@ -12,7 +12,7 @@
 typedef int int32;
 typedef unsigned int uint32;
 
-Encoder::Encoder(uint32 inputBufferLength): plainValue(0.0), wrappedValue(0.0),
+Encoder::Encoder(uint32 inputBufferLength): order(MAX_ORDER), plainValue(0.0), wrappedValue(0.0),
                                             intValueZero(0), intValueOne(0), fractionalValue(0.0),
                                             previousTheta(0.0), previousPhi(0.0),
                                             CONST_W(1.0 / sqrt(2.0)),
@@ -35,49 +35,44 @@ Encoder::Encoder(uint32 inputBufferLength): plainValue(0.0), wrappedValue(0.0),
   for (uint32 i = 0; i < 2; i++) {
     phiValues[i] = new double[3];
   }
+  coefficients = new double[MAX_CHANNELS];
+  for (uint32 i = 0; i < MAX_CHANNELS; i++) {
+    coefficients[i] = 0.0;
+  }
 }
 
 Encoder::~Encoder() {
   delete[] buffer;
+  for (uint32 i = 0; i < 2; i++) {
+    delete[] thetaValues[i];
+    delete[] phiValues[i];
+  }
   delete[] thetaValues;
   delete[] phiValues;
+  delete[] coefficients;
+}
+
+void Encoder::setOrder(uint32 inputOrder) {
+  order = inputOrder < MAX_ORDER ? inputOrder : MAX_ORDER;
+  initCoordinates(previousTheta, previousPhi);
 }
 
 void Encoder::initCoordinates(double inputTheta, double inputPhi) {
-  for (uint32 i = 0; i < 2; i++) {
-    for (uint32 j = 0; j < 2; j++) {
-      for (uint32 k = 0; k < 3; k++) {
-        if (i == 0) {
-          plainValue = inputTheta * bufferLength;
-        } else if (i == 1) {
-          plainValue = inputPhi * bufferLength;
-        }
-        if (j == 0) {
-          wrappedValue = wrap((j + 1) * plainValue, (unsigned int) 0, bufferLength);
-        } else if (j == 1) {
-          wrappedValue = wrap((j + 1) * plainValue + bufferLength * 0.25, (unsigned int) 0, bufferLength);
-        }
-        intValueZero = (int32) wrappedValue;
-        intValueOne = intValueZero + 1;
-        fractionalValue = wrappedValue - intValueZero;
-        if (i == 0) {
-          thetaValues[j][k] = buffer[intValueZero] * (1 - fractionalValue) + buffer[intValueOne] * fractionalValue;
-        } else if (i == 1) {
-          phiValues[j][k] = buffer[intValueZero] * (1 - fractionalValue) + buffer[intValueOne] * fractionalValue;
-        }
-      }
-    }
-  }
-  previousTheta = inputTheta;
-  previousPhi = inputPhi;
+  previousTheta = inputTheta + 1.0;
+  previousPhi = inputPhi + 1.0;
+  // FORZO IL RICALCOLO DI TUTTE LE TABELLE...
+  changeCoordinates(inputTheta, inputPhi);
 }
 
 void Encoder::changeCoordinates(double inputTheta, double inputPhi) {
+  if (inputTheta == previousTheta && inputPhi == previousPhi) {
+    return;
+  }
   if (inputTheta != previousTheta) {
     plainValue = inputTheta * bufferLength;
     // SCALO IL VALORE NORMALIZZATO ALLA DIMENSIONE DEL BUFFER...
     for (uint32 i = 0; i < 2; i++) {
-      for (uint32 j = 0; j < 3; j++) {
+      for (uint32 j = 0; j < order; j++) {
         if (i == 0) {
           wrappedValue = wrap((j + 1) * plainValue, (unsigned int) 0, bufferLength);
         } else if (i == 1) {
@@ -94,7 +89,7 @@ void Encoder::changeCoordinates(double inputTheta, double inputPhi) {
   if (inputPhi != previousPhi) {
     plainValue = inputPhi * bufferLength;
     for (uint32 i = 0; i < 2; i++) {
-      for (uint32 j = 0; j < 3; j++) {
+      for (uint32 j = 0; j < order; j++) {
         if (i == 0) {
           wrappedValue = wrap((j + 1) * plainValue, (unsigned int) 0, bufferLength);
         } else if (i == 1) {
@@ -109,56 +104,116 @@ void Encoder::changeCoordinates(double inputTheta, double inputPhi) {
   }
   previousTheta = inputTheta;
   previousPhi = inputPhi;
+  updateCoefficients();
 }
 
 double Encoder::oneSampleProcessor(double inputSample, uint32 inputChannel) {
-  if (inputChannel == 0) {
-    return inputSample * CONST_W;
-  } // W...
-  if (inputChannel == 1) {
-    return inputSample * thetaValues[1][0] * phiValues[1][0];
-  } // X...
-  if (inputChannel == 2) {
-    return inputSample * thetaValues[0][0] * phiValues[1][0];
-  } // Y...
-  if (inputChannel == 3) {
-    return inputSample * phiValues[0][0];
-  } // Z...
-  if (inputChannel == 4) {
-    return inputSample * (3.0 * phiValues[0][0] * phiValues[0][0] - 1) * 0.5;
-  } // R...
-  if (inputChannel == 5) {
-    return inputSample * thetaValues[1][0] * phiValues[0][1];
-  } // S...
-  if (inputChannel == 6) {
-    return inputSample * thetaValues[0][0] * phiValues[0][1];
-  } // T...
-  if (inputChannel == 7) {
-    return inputSample * thetaValues[1][1] * phiValues[1][0] * phiValues[1][0];
-  } // U...
-  if (inputChannel == 8) {
-    return inputSample * thetaValues[0][1] * phiValues[1][0] * phiValues[1][0];
-  } // V...
-  if (inputChannel == 9) {
-    return inputSample * phiValues[0][0] * (5.0 * phiValues[0][0] * phiValues[0][0] - 3.0) * 0.5;
-  } // K...
-  if (inputChannel == 10) {
-    return inputSample * thetaValues[1][0] * (5.0 * phiValues[0][0] * phiValues[0][0] - 1.0) * phiValues[1][0] * CONST_L;
-  } // L...
-  if (inputChannel == 11) {
-    return inputSample * thetaValues[0][0] * (5.0 * phiValues[0][0] * phiValues[0][0] - 1.0) * phiValues[1][0] * CONST_M;
-  } // M...
-  if (inputChannel == 12) {
-    return inputSample * thetaValues[1][1] * phiValues[0][0] * phiValues[1][0] * phiValues[1][0] * CONST_N;
-  } // N...
-  if (inputChannel == 13) {
-    return inputSample * thetaValues[0][1] * phiValues[0][0] * phiValues[1][0] * phiValues[1][0] * CONST_O;
-  } // O...
-  if (inputChannel == 14) {
-    return inputSample * thetaValues[1][2] * phiValues[1][0] * phiValues[1][0] * phiValues[1][0];
-  } // P...
-  if (inputChannel == 15) {
-    return inputSample * thetaValues[0][2] * phiValues[1][0] * phiValues[1][0] * phiValues[1][0];
-  } // Q...
+  if (inputChannel < MAX_CHANNELS) {
+    return inputSample * coefficients[inputChannel];
+  }
   return -10;
 }
+
+void Encoder::getCoefficients(double inputTheta, double inputPhi, double* outputCoefficients) {
+  double thetaRows[2][3];
+  double phiRows[2][3];
+  double* localThetaValues[2] = {thetaRows[0], thetaRows[1]};
+  double* localPhiValues[2] = {phiRows[0], phiRows[1]};
+  for (uint32 j = 0; j < 3; j++) {
+    thetaRows[0][j] = lookup((j + 1) * inputTheta);
+    thetaRows[1][j] = lookup((j + 1) * inputTheta + 0.25);
+    phiRows[0][j] = lookup((j + 1) * inputPhi);
+    phiRows[1][j] = lookup((j + 1) * inputPhi + 0.25);
+  }
+  // NON TOCCA LO STATO DELL'ENCODER: SERVE A CODIFICARE ALTRE DIREZIONI, PER ESEMPIO LE RIFLESSIONI...
+  fillCoefficients(localThetaValues, localPhiValues, outputCoefficients);
+}
+
+void Encoder::getDiffuseCoefficients(double* outputCoefficients) {
+  const uint32 numRings = 64;
+  const uint32 numPoints = 128;
+  double pointCoefficients[MAX_CHANNELS];
+  for (uint32 i = 0; i < MAX_CHANNELS; i++) {
+    outputCoefficients[i] = 0.0;
+  }
+  for (uint32 ring = 0; ring < numRings; ring++) {
+    double inputPhi = asin(-1.0 + (ring + 0.5) * 2.0 / numRings) / (2.0 * M_PI);
+    // ANELLI EQUISPAZIATI IN z, QUINDI DI AREA UGUALE...
+    for (uint32 point = 0; point < numPoints; point++) {
+      getCoefficients((double) point / numPoints, inputPhi, pointCoefficients);
+      for (uint32 i = 0; i < getChannelCount(order); i++) {
+        outputCoefficients[i] += pointCoefficients[i] * pointCoefficients[i];
+      }
+    }
+  }
+  for (uint32 i = 0; i < MAX_CHANNELS; i++) {
+    outputCoefficients[i] = sqrt(outputCoefficients[i] / (numRings * numPoints));
+  }
+  // VALORE EFFICACE DI OGNI CANALE SULLA SFERA: IL GUADAGNO DI UN CAMPO DIFFUSO, INDIPENDENTE DALLA DIREZIONE...
+}
+
+double Encoder::lookup(double inputValue) {
+  double wrapped = wrap(inputValue * bufferLength, (unsigned int) 0, bufferLength);
+  int32 intZero = (int32) wrapped;
+  double fractional = wrapped - intZero;
+  return buffer[intZero] * (1 - fractional) + buffer[intZero + 1] * fractional;
+}
+
+template <uint32 ORDER>
+void Encoder::multiChannelProcessor(const double* inputOrderSamples, float** outputChannels, uint32 inputSample) {
+  for (uint32 n = 0; n <= ORDER; n++) {
+    for (uint32 channel = n * n; channel < (n + 1) * (n + 1); channel++) {
+      outputChannels[channel][inputSample] = (float) (inputOrderSamples[n] * coefficients[channel]);
+    }
+  }
+  // CON L'ORDINE NOTO IN COMPILAZIONE I CICLI VENGONO SROTOLATI...
+}
+
+Encoder::Kernel Encoder::getKernel(uint32 inputOrder) {
+  switch (inputOrder) {
+  case 0:
+    return &Encoder::multiChannelProcessor<0>;
+  case 1:
+    return &Encoder::multiChannelProcessor<1>;
+  case 2:
+    return &Encoder::multiChannelProcessor<2>;
+  default:
+    return &Encoder::multiChannelProcessor<3>;
+  }
+}
+
+uint32 Encoder::getChannelCount(uint32 inputOrder) {
+  return (inputOrder + 1) * (inputOrder + 1);
+}
+
+void Encoder::updateCoefficients() {
+  fillCoefficients(thetaValues, phiValues, coefficients);
+}
+
+void Encoder::fillCoefficients(double** inputThetaValues, double** inputPhiValues, double* outputCoefficients) {
+  outputCoefficients[0] = CONST_W; // W...
+  if (order < 1) {
+    return;
+  }
+  outputCoefficients[1] = inputThetaValues[1][0] * inputPhiValues[1][0]; // X...
+  outputCoefficients[2] = inputThetaValues[0][0] * inputPhiValues[1][0]; // Y...
+  outputCoefficients[3] = inputPhiValues[0][0]; // Z...
+  if (order < 2) {
+    return;
+  }
+  outputCoefficients[4] = (3.0 * inputPhiValues[0][0] * inputPhiValues[0][0] - 1) * 0.5; // R...
+  outputCoefficients[5] = inputThetaValues[1][0] * inputPhiValues[0][1]; // S...
+  outputCoefficients[6] = inputThetaValues[0][0] * inputPhiValues[0][1]; // T...
+  outputCoefficients[7] = inputThetaValues[1][1] * inputPhiValues[1][0] * inputPhiValues[1][0]; // U...
+  outputCoefficients[8] = inputThetaValues[0][1] * inputPhiValues[1][0] * inputPhiValues[1][0]; // V...
+  if (order < 3) {
+    return;
+  }
+  outputCoefficients[9] = inputPhiValues[0][0] * (5.0 * inputPhiValues[0][0] * inputPhiValues[0][0] - 3.0) * 0.5; // K...
+  outputCoefficients[10] = inputThetaValues[1][0] * (5.0 * inputPhiValues[0][0] * inputPhiValues[0][0] - 1.0) * inputPhiValues[1][0] * CONST_L; // L...
+  outputCoefficients[11] = inputThetaValues[0][0] * (5.0 * inputPhiValues[0][0] * inputPhiValues[0][0] - 1.0) * inputPhiValues[1][0] * CONST_M; // M...
+  outputCoefficients[12] = inputThetaValues[1][1] * inputPhiValues[0][0] * inputPhiValues[1][0] * inputPhiValues[1][0] * CONST_N; // N...
+  outputCoefficients[13] = inputThetaValues[0][1] * inputPhiValues[0][0] * inputPhiValues[1][0] * inputPhiValues[1][0] * CONST_O; // O...
+  outputCoefficients[14] = inputThetaValues[1][2] * inputPhiValues[1][0] * inputPhiValues[1][0] * inputPhiValues[1][0]; // P...
+  outputCoefficients[15] = inputThetaValues[0][2] * inputPhiValues[1][0] * inputPhiValues[1][0] * inputPhiValues[1][0]; // Q...
+}
@@ -1,7 +1,7 @@
 //-----------------------------------------------------------------------------
 // Encoder.h
-// The Encoder class implements a 3rd order ambisonic encoder with FuMa
-// channel ordering and MaxN normalization coefficients.
+// The Encoder class implements a 1st, 2nd or 3rd order ambisonic encoder
+// with FuMa channel ordering and MaxN normalization coefficients.
 // © 2017, Rodolfo Cangiotti. Some rights reserved.
 //-----------------------------------------------------------------------------
 
@@ -12,16 +12,33 @@ typedef unsigned int uint32;
 
 class Encoder {
 public:
+  static const uint32 MAX_ORDER = 3;
+  static const uint32 MAX_CHANNELS = 16;
+  typedef void (Encoder::*Kernel)(const double* inputOrderSamples, float** outputChannels, uint32 inputSample);
   Encoder(uint32 inputBufferLength);
   ~Encoder();
+  void setOrder(uint32 inputOrder);
   void initCoordinates(double inputTheta, double inputPhi);
   void changeCoordinates(double inputTheta, double inputPhi);
   double oneSampleProcessor(double inputSample, uint32 inputChannel);
+  void getCoefficients(double inputTheta, double inputPhi, double* outputCoefficients);
+  void getDiffuseCoefficients(double* outputCoefficients);
+  template <uint32 ORDER>
+  void multiChannelProcessor(const double* inputOrderSamples, float** outputChannels, uint32 inputSample);
+  static Kernel getKernel(uint32 inputOrder);
+  static uint32 getChannelCount(uint32 inputOrder);
 private:
+  void updateCoefficients();
+  void fillCoefficients(double** inputThetaValues, double** inputPhiValues, double* outputCoefficients);
+  double lookup(double inputValue);
+  uint32 order;
+  // SI CALCOLANO SOLO I COEFFICIENTI FINO ALL'ORDINE RICHIESTO...
   double* buffer;
   uint32 bufferLength;
   double** thetaValues;
   double** phiValues;
+  double* coefficients;
+  // UN GUADAGNO PER CANALE, RICALCOLATO SOLO QUANDO CAMBIANO LE COORDINATE...
   double plainValue;
   // OSSIA NON NORMALIZZATO...
   double wrappedValue;
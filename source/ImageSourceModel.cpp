@@ -0,0 +1,111 @@
+//-----------------------------------------------------------------------------
+// ImageSourceModel.cpp
+// The ImageSourceModel class implements the image-source method for a
+// shoebox room centered on the listener: it computes the direction, the path
+// length and the wall attenuation of the 1st and 2nd order reflections.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "ImageSourceModel.h"
+#include <cmath>
+#include <cstdlib>
+
+typedef int int32;
+typedef unsigned int uint32;
+
+static const double TWO_PI = 6.283185307179586;
+
+static double clampToRoom(double inputCoordinate, double inputHalfSize) {
+  if (inputCoordinate > inputHalfSize) {
+    return inputHalfSize;
+  }
+  if (inputCoordinate < -inputHalfSize) {
+    return -inputHalfSize;
+  }
+  return inputCoordinate;
+}
+
+ImageSourceModel::ImageSourceModel(): WALL_MARGIN(0.1) {
+  uint32 index = 0;
+  for (int32 i = -2; i <= 2; i++) {
+    for (int32 j = -2; j <= 2; j++) {
+      for (int32 k = -2; k <= 2; k++) {
+        uint32 count = abs(i) + abs(j) + abs(k);
+        if (count < 1 || count > 2) {
+          continue;
+        }
+        imageX[index] = i;
+        imageY[index] = j;
+        imageZ[index] = k;
+        bounces[index] = count;
+        index++;
+      }
+    }
+  }
+  // 6 IMMAGINI DEL 1o ORDINE E 18 DEL 2o ORDINE...
+  for (uint32 i = 0; i < MAX_REFLECTIONS; i++) {
+    thetas[i] = 0.0;
+    phis[i] = 0.0;
+    distances[i] = 1.0;
+    gains[i] = 0.0;
+  }
+  reset();
+}
+
+ImageSourceModel::~ImageSourceModel() {
+
+}
+
+bool ImageSourceModel::update(double inputTheta, double inputPhi, double inputDistance, double inputLength, double inputWidth, double inputHeight, double inputReflection) {
+  double inputs[7] = {inputTheta, inputPhi, inputDistance, inputLength, inputWidth, inputHeight, inputReflection};
+  bool hasChanged = false;
+  for (uint32 i = 0; i < 7; i++) {
+    if (inputs[i] != previousInputs[i]) {
+      hasChanged = true;
+    }
+    previousInputs[i] = inputs[i];
+  }
+  if (!hasChanged) {
+    return false;
+  }
+  // LA GEOMETRIA VIENE RICALCOLATA SOLO QUANDO LA SORGENTE O LA STANZA CAMBIANO...
+  double azimuth = inputTheta * TWO_PI;
+  double elevation = inputPhi * TWO_PI;
+  double sourceX = clampToRoom(inputDistance * cos(elevation) * cos(azimuth), inputLength * 0.5 - WALL_MARGIN);
+  double sourceY = clampToRoom(inputDistance * cos(elevation) * sin(azimuth), inputWidth * 0.5 - WALL_MARGIN);
+  double sourceZ = clampToRoom(inputDistance * sin(elevation), inputHeight * 0.5 - WALL_MARGIN);
+  // UNA SORGENTE OLTRE LE PARETI VIENE RIPORTATA ALL'INTERNO DELLA STANZA...
+  for (uint32 i = 0; i < MAX_REFLECTIONS; i++) {
+    double x = imageX[i] * inputLength + (abs(imageX[i]) % 2 ? -sourceX : sourceX);
+    double y = imageY[i] * inputWidth + (abs(imageY[i]) % 2 ? -sourceY : sourceY);
+    double z = imageZ[i] * inputHeight + (abs(imageZ[i]) % 2 ? -sourceZ : sourceZ);
+    // OGNI RIFLESSIONE SPECCHIA LA COORDINATA, UN NUMERO PARI DI RIFLESSIONI LA TRASLA SOLTANTO...
+    distances[i] = sqrt(x * x + y * y + z * z);
+    thetas[i] = atan2(y, x) / TWO_PI;
+    phis[i] = asin(z / distances[i]) / TWO_PI;
+    gains[i] = pow(inputReflection, (double) bounces[i]);
+  }
+  return true;
+}
+
+void ImageSourceModel::reset() {
+  for (uint32 i = 0; i < 7; i++) {
+    previousInputs[i] = -1.0;
+  }
+}
+
+double ImageSourceModel::getTheta(uint32 inputReflection) {
+  return thetas[inputReflection];
+}
+
+double ImageSourceModel::getPhi(uint32 inputReflection) {
+  return phis[inputReflection];
+}
+
+double ImageSourceModel::getDistance(uint32 inputReflection) {
+  return distances[inputReflection];
+}
+
+double ImageSourceModel::getGain(uint32 inputReflection) {
+  return gains[inputReflection];
+}
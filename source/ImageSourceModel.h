@@ -0,0 +1,37 @@
+//-----------------------------------------------------------------------------
+// ImageSourceModel.h
+// The ImageSourceModel class implements the image-source method for a
+// shoebox room centered on the listener: it computes the direction, the path
+// length and the wall attenuation of the 1st and 2nd order reflections.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+typedef int int32;
+typedef unsigned int uint32;
+
+class ImageSourceModel {
+public:
+  static const uint32 MAX_REFLECTIONS = 24;
+  ImageSourceModel();
+  ~ImageSourceModel();
+  bool update(double inputTheta, double inputPhi, double inputDistance, double inputLength, double inputWidth, double inputHeight, double inputReflection);
+  void reset();
+  double getTheta(uint32 inputReflection);
+  double getPhi(uint32 inputReflection);
+  double getDistance(uint32 inputReflection);
+  double getGain(uint32 inputReflection);
+private:
+  int32 imageX[MAX_REFLECTIONS];
+  int32 imageY[MAX_REFLECTIONS];
+  int32 imageZ[MAX_REFLECTIONS];
+  uint32 bounces[MAX_REFLECTIONS];
+  // INDICI DELLE IMMAGINI LUNGO I TRE ASSI E NUMERO DI PARETI ATTRAVERSATE...
+  double thetas[MAX_REFLECTIONS];
+  double phis[MAX_REFLECTIONS];
+  double distances[MAX_REFLECTIONS];
+  double gains[MAX_REFLECTIONS];
+  double previousInputs[7];
+  const double WALL_MARGIN;
+};
@@ -0,0 +1,111 @@
+//-----------------------------------------------------------------------------
+// NearFieldFilter.cpp
+// The NearFieldFilter class implements the near-field compensation filters
+// of the 1st, 2nd and 3rd order ambisonic components as a bank of IIR
+// sections, parameterized by source distance and reference radius.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "NearFieldFilter.h"
+
+typedef int int32;
+typedef unsigned int uint32;
+
+static const double FIRST_ORDER_ROOT = -1.0;
+static const double SECOND_ORDER_ROOT[2] = {-1.5, 0.8660254037844386};
+static const double THIRD_ORDER_REAL_ROOT = -2.3221853546260855;
+static const double THIRD_ORDER_COMPLEX_ROOT[2] = {-1.8389073226869570, 1.7543809597837536};
+// RADICI DEI POLINOMI DI BESSEL INVERSI DI ORDINE 1, 2 E 3...
+
+NearFieldFilter::NearFieldFilter(): previousDistance(-1.0), previousReferenceRadius(-1.0), previousSampleRate(-1.0),
+                                    SPEED_OF_SOUND(343.0), MIN_DISTANCE_RATIO(0.5) {
+  for (uint32 i = 0; i < NUM_LANES; i++) {
+    firstB0[i] = 1.0;
+    firstB1[i] = 0.0;
+    firstA1[i] = 0.0;
+    biquadB0[i] = 1.0;
+    biquadB1[i] = 0.0;
+    biquadB2[i] = 0.0;
+    biquadA1[i] = 0.0;
+    biquadA2[i] = 0.0;
+  }
+  clear();
+}
+
+NearFieldFilter::~NearFieldFilter() {
+
+}
+
+void NearFieldFilter::setDistance(double inputDistance, double inputReferenceRadius, double inputSampleRate) {
+  if (inputDistance == previousDistance && inputReferenceRadius == previousReferenceRadius && inputSampleRate == previousSampleRate) {
+    return;
+  }
+  previousDistance = inputDistance;
+  previousReferenceRadius = inputReferenceRadius;
+  previousSampleRate = inputSampleRate;
+  double distance = inputDistance;
+  if (distance < inputReferenceRadius * MIN_DISTANCE_RATIO) {
+    distance = inputReferenceRadius * MIN_DISTANCE_RATIO;
+  }
+  // IL GUADAGNO IN CONTINUA DELL'ORDINE n VALE (R / r)^n: LIMITO r PER CONTENERE L'ENFASI DEI BASSI...
+  double zeroScale = SPEED_OF_SOUND / distance;
+  double poleScale = SPEED_OF_SOUND / inputReferenceRadius;
+  double k = 2.0 * inputSampleRate;
+  setFirstOrderSection(0, FIRST_ORDER_ROOT, zeroScale, poleScale, k);
+  setFirstOrderSection(1, THIRD_ORDER_REAL_ROOT, zeroScale, poleScale, k);
+  setBiquadSection(0, SECOND_ORDER_ROOT[0], SECOND_ORDER_ROOT[1], zeroScale, poleScale, k);
+  setBiquadSection(1, THIRD_ORDER_COMPLEX_ROOT[0], THIRD_ORDER_COMPLEX_ROOT[1], zeroScale, poleScale, k);
+}
+
+void NearFieldFilter::setFirstOrderSection(uint32 inputLane, double inputRoot, double inputZeroScale, double inputPoleScale, double inputK) {
+  double zero = inputRoot * inputZeroScale;
+  double pole = inputRoot * inputPoleScale;
+  double normalization = 1.0 / (inputK - pole);
+  firstB0[inputLane] = (inputK - zero) * normalization;
+  firstB1[inputLane] = (-inputK - zero) * normalization;
+  firstA1[inputLane] = (-inputK - pole) * normalization;
+  // (s - zero) / (s - pole) TRASFORMATA CON s = K (1 - z^-1) / (1 + z^-1)...
+}
+
+void NearFieldFilter::setBiquadSection(uint32 inputLane, double inputReal, double inputImaginary, double inputZeroScale, double inputPoleScale, double inputK) {
+  double magnitude = inputReal * inputReal + inputImaginary * inputImaginary;
+  double zeroLinear = -2.0 * inputReal * inputZeroScale;
+  double zeroConstant = magnitude * inputZeroScale * inputZeroScale;
+  double poleLinear = -2.0 * inputReal * inputPoleScale;
+  double poleConstant = magnitude * inputPoleScale * inputPoleScale;
+  double kSquared = inputK * inputK;
+  double normalization = 1.0 / (kSquared + poleLinear * inputK + poleConstant);
+  biquadB0[inputLane] = (kSquared + zeroLinear * inputK + zeroConstant) * normalization;
+  biquadB1[inputLane] = 2.0 * (zeroConstant - kSquared) * normalization;
+  biquadB2[inputLane] = (kSquared - zeroLinear * inputK + zeroConstant) * normalization;
+  biquadA1[inputLane] = 2.0 * (poleConstant - kSquared) * normalization;
+  biquadA2[inputLane] = (kSquared - poleLinear * inputK + poleConstant) * normalization;
+}
+
+void NearFieldFilter::clear() {
+  for (uint32 i = 0; i < NUM_LANES; i++) {
+    firstState[i] = 0.0;
+    biquadState1[i] = 0.0;
+    biquadState2[i] = 0.0;
+  }
+}
+
+void NearFieldFilter::oneSampleProcessor(double* inputOrderSamples) {
+  double firstInput[NUM_LANES] = {inputOrderSamples[1], inputOrderSamples[3]};
+  double firstOutput[NUM_LANES];
+  for (uint32 i = 0; i < NUM_LANES; i++) {
+    firstOutput[i] = firstB0[i] * firstInput[i] + firstState[i];
+    firstState[i] = firstB1[i] * firstInput[i] - firstA1[i] * firstOutput[i];
+  }
+  // LE CORSIE SONO INDIPENDENTI, IL CICLO PUO' ESSERE VETTORIZZATO...
+  double biquadInput[NUM_LANES] = {inputOrderSamples[2], firstOutput[1]};
+  double biquadOutput[NUM_LANES];
+  for (uint32 i = 0; i < NUM_LANES; i++) {
+    biquadOutput[i] = biquadB0[i] * biquadInput[i] + biquadState1[i];
+    biquadState1[i] = biquadB1[i] * biquadInput[i] - biquadA1[i] * biquadOutput[i] + biquadState2[i];
+    biquadState2[i] = biquadB2[i] * biquadInput[i] - biquadA2[i] * biquadOutput[i];
+  }
+  inputOrderSamples[1] = firstOutput[0];
+  inputOrderSamples[2] = biquadOutput[0];
+  inputOrderSamples[3] = biquadOutput[1];
+}
@@ -0,0 +1,43 @@
+//-----------------------------------------------------------------------------
+// NearFieldFilter.h
+// The NearFieldFilter class implements the near-field compensation filters
+// of the 1st, 2nd and 3rd order ambisonic components as a bank of IIR
+// sections, parameterized by source distance and reference radius.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+typedef int int32;
+typedef unsigned int uint32;
+
+class NearFieldFilter {
+public:
+  static const uint32 NUM_LANES = 2;
+  NearFieldFilter();
+  ~NearFieldFilter();
+  void setDistance(double inputDistance, double inputReferenceRadius, double inputSampleRate);
+  void clear();
+  void oneSampleProcessor(double* inputOrderSamples);
+private:
+  void setFirstOrderSection(uint32 inputLane, double inputRoot, double inputZeroScale, double inputPoleScale, double inputK);
+  void setBiquadSection(uint32 inputLane, double inputReal, double inputImaginary, double inputZeroScale, double inputPoleScale, double inputK);
+  double firstB0[NUM_LANES];
+  double firstB1[NUM_LANES];
+  double firstA1[NUM_LANES];
+  double firstState[NUM_LANES];
+  // SEZIONI DEL 1o ORDINE: CORSIA 0 PER L'ORDINE 1, CORSIA 1 PER L'ORDINE 3...
+  double biquadB0[NUM_LANES];
+  double biquadB1[NUM_LANES];
+  double biquadB2[NUM_LANES];
+  double biquadA1[NUM_LANES];
+  double biquadA2[NUM_LANES];
+  double biquadState1[NUM_LANES];
+  double biquadState2[NUM_LANES];
+  // SEZIONI DEL 2o ORDINE: CORSIA 0 PER L'ORDINE 2, CORSIA 1 PER L'ORDINE 3...
+  double previousDistance;
+  double previousReferenceRadius;
+  double previousSampleRate;
+  const double SPEED_OF_SOUND;
+  const double MIN_DISTANCE_RATIO;
+};
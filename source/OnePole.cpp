@@ -0,0 +1,29 @@
+//-----------------------------------------------------------------------------
+// OnePole.cpp
+// The OnePole class implements a one-pole low-pass filter.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "OnePole.h"
+#include <cmath>
+
+OnePole::OnePole(): coefficient(1.0), previousOutput(0.0) {
+
+}
+
+OnePole::~OnePole() {
+
+}
+
+void OnePole::setCutoff(double inputFrequency, double inputSampleRate) {
+  coefficient = 1.0 - exp(-2.0 * M_PI * inputFrequency / inputSampleRate);
+}
+
+void OnePole::clear() {
+  previousOutput = 0.0;
+}
+
+double OnePole::oneSampleProcessor(double inputSample) {
+  previousOutput += coefficient * (inputSample - previousOutput);
+  return previousOutput;
+}
@@ -0,0 +1,19 @@
+//-----------------------------------------------------------------------------
+// OnePole.h
+// The OnePole class implements a one-pole low-pass filter.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+class OnePole {
+public:
+  OnePole();
+  ~OnePole();
+  void setCutoff(double inputFrequency, double inputSampleRate);
+  void clear();
+  double oneSampleProcessor(double inputSample);
+private:
+  double coefficient;
+  double previousOutput;
+};
@@ -0,0 +1,155 @@
+//-----------------------------------------------------------------------------
+// OrderBudget.cpp
+// The OrderBudget class shares a global channel budget among all the encoder
+// instances of the process and assigns each of them an effective ambisonic
+// order according to its priority.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "OrderBudget.h"
+#include "Encoder.h"
+#include <algorithm>
+#include <cstdlib>
+
+typedef int int32;
+typedef unsigned int uint32;
+
+OrderBudget::OrderBudget(): numSlots(0), budget(MAX_SOURCES * Encoder::MAX_CHANNELS), allocatedChannels(0), isDirty(false) {
+  isAllocating.clear();
+  for (uint32 i = 0; i < MAX_SOURCES; i++) {
+    isActive[i] = false;
+    priorities[i] = 0.0f;
+    maxOrders[i] = Encoder::MAX_ORDER;
+    orders[i] = Encoder::MAX_ORDER;
+  }
+  const char* channels = getenv("AMBIENCODER_ORDER_BUDGET");
+  if (channels && atoi(channels) > 0) {
+    budget = (uint32) atoi(channels);
+  }
+  // IL BUDGET E' UNICO PER TUTTO IL PROCESSO, IN CANALI DI USCITA: NON E' UN PARAMETRO DELLE SINGOLE ISTANZE...
+}
+
+OrderBudget& OrderBudget::getInstance() {
+  static OrderBudget instance;
+  return instance;
+}
+
+int32 OrderBudget::registerSource() {
+  std::lock_guard<std::mutex> lock(registrationMutex);
+  for (uint32 i = 0; i < MAX_SOURCES; i++) {
+    if (!isActive[i]) {
+      priorities[i] = 1.0f;
+      maxOrders[i] = Encoder::MAX_ORDER;
+      orders[i] = 0;
+      isActive[i] = true;
+      if (i >= numSlots) {
+        numSlots = i + 1;
+      }
+      isDirty = true;
+      return (int32) i;
+    }
+  }
+  // TROPPE ISTANZE, LA SORGENTE NON E' SOGGETTA AL BUDGET...
+  return -1;
+}
+
+void OrderBudget::unregisterSource(int32 inputSlot) {
+  if (inputSlot < 0 || inputSlot >= (int32) MAX_SOURCES) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(registrationMutex);
+  isActive[inputSlot] = false;
+  uint32 slots = numSlots;
+  while (slots > 0 && !isActive[slots - 1]) {
+    slots--;
+  }
+  numSlots = slots;
+  isDirty = true;
+}
+
+void OrderBudget::setBudget(uint32 inputChannels) {
+  if (budget.exchange(inputChannels) != inputChannels) {
+    isDirty = true;
+  }
+}
+
+void OrderBudget::setPriority(int32 inputSlot, float inputPriority) {
+  if (inputSlot < 0 || inputSlot >= (int32) MAX_SOURCES) {
+    return;
+  }
+  if (priorities[inputSlot].exchange(inputPriority) != inputPriority) {
+    isDirty = true;
+  }
+}
+
+void OrderBudget::setMaxOrder(int32 inputSlot, uint32 inputMaxOrder) {
+  if (inputSlot < 0 || inputSlot >= (int32) MAX_SOURCES) {
+    return;
+  }
+  if (maxOrders[inputSlot].exchange(inputMaxOrder) != inputMaxOrder) {
+    isDirty = true;
+  }
+}
+
+uint32 OrderBudget::getOrder(int32 inputSlot) {
+  if (inputSlot < 0 || inputSlot >= (int32) MAX_SOURCES) {
+    return Encoder::MAX_ORDER;
+  }
+  if (isDirty.load(std::memory_order_acquire) && !isAllocating.test_and_set(std::memory_order_acquire)) {
+    isDirty = false;
+    allocate();
+    isAllocating.clear(std::memory_order_release);
+  }
+  // LE ALTRE ISTANZE LEGGONO L'ASSEGNAZIONE PRECEDENTE, AL PIU' IN RITARDO DI UN BLOCCO...
+  return orders[inputSlot].load(std::memory_order_relaxed);
+}
+
+uint32 OrderBudget::getBudget() {
+  return budget;
+}
+
+uint32 OrderBudget::getAllocatedChannels() {
+  return allocatedChannels;
+}
+
+void OrderBudget::allocate() {
+  uint32 slots = numSlots;
+  uint32 count = 0;
+  for (uint32 i = 0; i < slots; i++) {
+    if (isActive[i]) {
+      ranking[count] = i;
+      rankingPriorities[i] = priorities[i];
+      count++;
+    }
+  }
+  // LE PRIORITA' VENGONO COPIATE: DURANTE L'ORDINAMENTO NON DEVONO CAMBIARE...
+  const float* keys = rankingPriorities;
+  std::sort(ranking, ranking + count, [keys](uint32 first, uint32 second) {
+    return keys[first] > keys[second] || (keys[first] == keys[second] && first < second);
+  });
+  // PRIORITA' DECRESCENTE: A PARITA' VINCE LO SLOT PIU' BASSO...
+  uint32 available = budget;
+  available = available > count ? available - count : 0;
+  uint32 granted[MAX_SOURCES];
+  for (uint32 i = 0; i < count; i++) {
+    granted[i] = 0;
+  }
+  // L'ORDINE ZERO (IL SOLO CANALE W) VIENE SEMPRE CONCESSO...
+  for (uint32 order = 1; order <= Encoder::MAX_ORDER; order++) {
+    uint32 cost = Encoder::getChannelCount(order) - Encoder::getChannelCount(order - 1);
+    for (uint32 i = 0; i < count && available >= cost; i++) {
+      if (maxOrders[ranking[i]] >= order && granted[i] == order - 1) {
+        granted[i] = order;
+        available -= cost;
+      }
+    }
+  }
+  // UN ORDINE ALLA VOLTA: TUTTE LE SORGENTI SALGONO AL 1o ORDINE PRIMA CHE UNA PASSI AL 2o...
+  uint32 channels = 0;
+  for (uint32 i = 0; i < count; i++) {
+    orders[ranking[i]].store(granted[i], std::memory_order_relaxed);
+    channels += Encoder::getChannelCount(granted[i]);
+  }
+  allocatedChannels = channels;
+  // I CANALI CODIFICATI SONO LA MISURA DEL CARICO: IL COSTO DI UNA SORGENTE CRESCE CON (N+1)^2...
+}
@@ -0,0 +1,48 @@
+//-----------------------------------------------------------------------------
+// OrderBudget.h
+// The OrderBudget class shares a global channel budget among all the encoder
+// instances of the process and assigns each of them an effective ambisonic
+// order according to its priority.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+typedef int int32;
+typedef unsigned int uint32;
+
+class OrderBudget {
+public:
+  static const uint32 MAX_SOURCES = 1024;
+  static OrderBudget& getInstance();
+  int32 registerSource();
+  void unregisterSource(int32 inputSlot);
+  void setBudget(uint32 inputChannels);
+  void setPriority(int32 inputSlot, float inputPriority);
+  void setMaxOrder(int32 inputSlot, uint32 inputMaxOrder);
+  uint32 getOrder(int32 inputSlot);
+  uint32 getBudget();
+  uint32 getAllocatedChannels();
+private:
+  OrderBudget();
+  OrderBudget(const OrderBudget&);
+  OrderBudget& operator=(const OrderBudget&);
+  void allocate();
+  std::mutex registrationMutex;
+  // USATO SOLO FUORI DAL THREAD AUDIO...
+  std::atomic<bool> isActive[MAX_SOURCES];
+  std::atomic<float> priorities[MAX_SOURCES];
+  std::atomic<uint32> maxOrders[MAX_SOURCES];
+  std::atomic<uint32> orders[MAX_SOURCES];
+  std::atomic<uint32> numSlots;
+  std::atomic<uint32> budget;
+  std::atomic<uint32> allocatedChannels;
+  std::atomic<bool> isDirty;
+  std::atomic_flag isAllocating;
+  // L'ASSEGNAZIONE VIENE RICALCOLATA DA UNA SOLA ISTANZA, E SOLO DOPO UNA MODIFICA...
+  uint32 ranking[MAX_SOURCES];
+  float rankingPriorities[MAX_SOURCES];
+};
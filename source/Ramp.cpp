@@ -21,7 +21,8 @@ Ramp::~Ramp() {
 double Ramp::oneSampleProcessor(double inputSample) {
   if (inputSample - previousInput) {
     isRamping = true;
-    incrementValue = (inputSample - previousInput) / blockSize;
+    incrementValue = (inputSample - previousOutput) / blockSize;
+    // PARTO DALL'ULTIMO VALORE IN USCITA, COSI' UNA RAMPA INTERROTTA NON SUPERA IL VALORE FINALE...
     cycleCounter = blockSize;
   }
   //-----------------------
@@ -33,6 +34,8 @@ double Ramp::oneSampleProcessor(double inputSample) {
     cycleCounter -= 1;
     if (!cycleCounter) {
       isRamping = false;
+      output = inputSample;
+      previousOutput = output;
     }
     return output;
   }
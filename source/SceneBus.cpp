@@ -0,0 +1,142 @@
+//-----------------------------------------------------------------------------
+// SceneBus.cpp
+// The SceneBus class implements a process-local B-format summing bus: the
+// sending encoder instances publish their encoded block in a private slot and
+// a single collector instance sums all the slots into its own output.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "SceneBus.h"
+#include <cstdint>
+#include <cstring>
+
+typedef int int32;
+typedef unsigned int uint32;
+typedef long long int64;
+
+SceneBus::SceneBus(): numSlots(0), hasCollector(false) {
+  for (uint32 i = 0; i < MAX_SLOTS; i++) {
+    slots[i].isActive = false;
+    slots[i].isReading = false;
+    slots[i].hasData = false;
+    slots[i].writeEnd = 0;
+    slots[i].numChannels = 0;
+    slots[i].ringFrames = 0;
+    slots[i].ringMask = 0;
+    slots[i].storage = nullptr;
+    slots[i].buffer = nullptr;
+  }
+}
+
+SceneBus& SceneBus::getInstance() {
+  static SceneBus instance;
+  return instance;
+}
+
+int32 SceneBus::registerSlot(uint32 inputNumChannels, uint32 inputMaxBlockSize) {
+  std::lock_guard<std::mutex> lock(registrationMutex);
+  for (uint32 i = 0; i < MAX_SLOTS; i++) {
+    Slot& slot = slots[i];
+    if (slot.isActive) {
+      continue;
+    }
+    slot.numChannels = inputNumChannels;
+    slot.ringFrames = 16;
+    while (slot.ringFrames < 4 * inputMaxBlockSize) {
+      slot.ringFrames <<= 1;
+    }
+    // IL MITTENTE SCRIVE AL PIU' UN BLOCCO AVANTI, IL COLLETTORE LEGGE UN BLOCCO INDIETRO: LE DUE ZONE NON SI SOVRAPPONGONO...
+    slot.ringMask = slot.ringFrames - 1;
+    slot.storage = new float[slot.numChannels * slot.ringFrames + 16];
+    slot.buffer = (float*) (((uintptr_t) slot.storage + 63) & ~(uintptr_t) 63);
+    memset(slot.buffer, 0, slot.numChannels * slot.ringFrames * sizeof(float));
+    // OGNI CANALE INIZIA SU UNA NUOVA LINEA DI CACHE (16 float = 64 byte)...
+    slot.hasData = false;
+    slot.writeEnd = 0;
+    slot.isActive = true;
+    if (i >= numSlots) {
+      numSlots = i + 1;
+    }
+    return (int32) i;
+  }
+  return -1;
+}
+
+void SceneBus::unregisterSlot(int32 inputSlot) {
+  if (inputSlot < 0 || inputSlot >= (int32) MAX_SLOTS) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(registrationMutex);
+  Slot& slot = slots[inputSlot];
+  slot.isActive = false;
+  while (slot.isReading) {
+    // IL COLLETTORE STA ANCORA LEGGENDO QUESTO SLOT...
+  }
+  delete[] slot.storage;
+  slot.storage = nullptr;
+  slot.buffer = nullptr;
+  uint32 slotCount = numSlots;
+  while (slotCount > 0 && !slots[slotCount - 1].isActive) {
+    slotCount--;
+  }
+  numSlots = slotCount;
+}
+
+bool SceneBus::acquireCollector() {
+  bool isFree = false;
+  return hasCollector.compare_exchange_strong(isFree, true);
+  // UN SECONDO COLLETTORE SOTTRARREBBE I BLOCCHI AL PRIMO, QUINDI VIENE RIFIUTATO...
+}
+
+void SceneBus::releaseCollector() {
+  hasCollector = false;
+}
+
+void SceneBus::publish(int32 inputSlot, float** inputChannels, uint32 numSamples, int64 inputTime) {
+  if (inputSlot < 0 || inputSlot >= (int32) MAX_SLOTS) {
+    return;
+  }
+  Slot& slot = slots[inputSlot];
+  if (numSamples > slot.ringFrames / 4) {
+    return;
+  }
+  uint32 start = (uint32) ((uint64_t) inputTime & slot.ringMask);
+  uint32 firstPart = slot.ringFrames - start < numSamples ? slot.ringFrames - start : numSamples;
+  for (uint32 i = 0; i < slot.numChannels; i++) {
+    float* channel = slot.buffer + i * slot.ringFrames;
+    memcpy(channel + start, inputChannels[i], firstPart * sizeof(float));
+    memcpy(channel, inputChannels[i] + firstPart, (numSamples - firstPart) * sizeof(float));
+  }
+  slot.writeEnd.store(inputTime + numSamples, std::memory_order_release);
+  slot.hasData.store(true, std::memory_order_release);
+  // I CAMPIONI SONO INDICIZZATI PER TEMPO ASSOLUTO: L'ORDINE DI ELABORAZIONE DELLE ISTANZE NON CONTA...
+}
+
+void SceneBus::collect(float** outputChannels, uint32 numChannels, uint32 numSamples, int64 inputTime) {
+  uint32 slotCount = numSlots;
+  int64 end = inputTime + numSamples;
+  for (uint32 i = 0; i < slotCount; i++) {
+    Slot& slot = slots[i];
+    slot.isReading = true;
+    if (!slot.isActive || !slot.hasData.load(std::memory_order_acquire)) {
+      slot.isReading = false;
+      continue;
+    }
+    int64 writeEnd = slot.writeEnd.load(std::memory_order_acquire);
+    if (writeEnd < end || writeEnd - slot.ringFrames > inputTime) {
+      slot.isReading = false;
+      continue;
+    }
+    // ESATTAMENTE IL TRATTO RICHIESTO, O NIENTE SE IL MITTENTE NON L'HA ANCORA SCRITTO O L'HA GIA' SOVRASCRITTO...
+    uint32 start = (uint32) ((uint64_t) inputTime & slot.ringMask);
+    uint32 channels = slot.numChannels < numChannels ? slot.numChannels : numChannels;
+    for (uint32 channel = 0; channel < channels; channel++) {
+      const float* input = slot.buffer + channel * slot.ringFrames;
+      float* output = outputChannels[channel];
+      for (uint32 sample = 0; sample < numSamples; sample++) {
+        output[sample] += input[(start + sample) & slot.ringMask];
+      }
+    }
+    slot.isReading = false;
+  }
+}
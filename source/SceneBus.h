@@ -0,0 +1,48 @@
+//-----------------------------------------------------------------------------
+// SceneBus.h
+// The SceneBus class implements a process-local B-format summing bus: the
+// sending encoder instances publish their encoded block in a private slot and
+// a single collector instance sums all the slots into its own output.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+typedef int int32;
+typedef unsigned int uint32;
+typedef long long int64;
+
+class SceneBus {
+public:
+  static const uint32 MAX_SLOTS = 1024;
+  static SceneBus& getInstance();
+  int32 registerSlot(uint32 inputNumChannels, uint32 inputMaxBlockSize);
+  void unregisterSlot(int32 inputSlot);
+  bool acquireCollector();
+  void releaseCollector();
+  void publish(int32 inputSlot, float** inputChannels, uint32 numSamples, int64 inputTime);
+  void collect(float** outputChannels, uint32 numChannels, uint32 numSamples, int64 inputTime);
+private:
+  struct alignas(64) Slot {
+    std::atomic<bool> isActive;
+    std::atomic<bool> isReading;
+    std::atomic<bool> hasData;
+    std::atomic<int64> writeEnd;
+    uint32 numChannels;
+    uint32 ringFrames;
+    uint32 ringMask;
+    float* storage;
+    float* buffer;
+  };
+  // OGNI SLOT OCCUPA LINEE DI CACHE PROPRIE, COSI' GLI INVII NON SI CONTENDONO LA MEMORIA...
+  SceneBus();
+  SceneBus(const SceneBus&);
+  SceneBus& operator=(const SceneBus&);
+  std::mutex registrationMutex;
+  Slot slots[MAX_SLOTS];
+  std::atomic<uint32> numSlots;
+  std::atomic<bool> hasCollector;
+};
@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// SpreadTable.cpp
+// The SpreadTable class precomputes the per-order weights that widen a point
+// source into a uniform spherical cap, as a function of the spread angle.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "SpreadTable.h"
+#include "Encoder.h"
+#include <cmath>
+
+typedef int int32;
+typedef unsigned int uint32;
+
+static double legendre(uint32 order, double x) {
+  double previous = 1.0;
+  double current = x;
+  if (order == 0) {
+    return previous;
+  }
+  for (uint32 n = 1; n < order; n++) {
+    double next = ((2.0 * n + 1.0) * x * current - n * previous) / (n + 1.0);
+    previous = current;
+    current = next;
+  }
+  return current;
+}
+
+SpreadTable::SpreadTable(uint32 inputTableLength) {
+  tableLength = inputTableLength;
+  weights = new double*[Encoder::MAX_ORDER + 1];
+  diffuseWeights = new double*[Encoder::MAX_ORDER + 1];
+  for (uint32 order = 0; order <= Encoder::MAX_ORDER; order++) {
+    weights[order] = new double[tableLength + 1];
+    diffuseWeights[order] = new double[tableLength + 1];
+    // GUARD POINT...
+    for (uint32 i = 0; i <= tableLength; i++) {
+      double cosine = cos(M_PI * i / tableLength);
+      // LA DIFFUSIONE NORMALIZZATA CORRISPONDE A UNA CALOTTA CON SEMIAPERTURA DA 0 A 180 GRADI...
+      double weight = 1.0;
+      if (order > 0 && i > 0) {
+        weight = (legendre(order - 1, cosine) - legendre(order + 1, cosine)) / ((2.0 * order + 1.0) * (1.0 - cosine));
+      }
+      weights[order][i] = weight;
+      diffuseWeights[order][i] = order > 0 ? sqrt(fmax(0.0, 1.0 - weight * weight)) : 0.0;
+      // L'ENERGIA TOLTA ALLE COMPONENTI DIREZIONALI, RESTITUITA DAL SEGNALE DECORRELATO...
+    }
+  }
+}
+
+SpreadTable::~SpreadTable() {
+  for (uint32 order = 0; order <= Encoder::MAX_ORDER; order++) {
+    delete[] weights[order];
+    delete[] diffuseWeights[order];
+  }
+  delete[] weights;
+  delete[] diffuseWeights;
+}
+
+void SpreadTable::getWeights(double inputSpread, double* outputWeights, double* outputDiffuseWeights) {
+  double plainValue = inputSpread * tableLength;
+  plainValue = plainValue < 0.0 ? 0.0 : plainValue;
+  plainValue = plainValue > tableLength ? tableLength : plainValue;
+  uint32 intValueZero = (uint32) plainValue;
+  uint32 intValueOne = intValueZero < tableLength ? intValueZero + 1 : intValueZero;
+  double fractionalValue = plainValue - intValueZero;
+  for (uint32 order = 0; order <= Encoder::MAX_ORDER; order++) {
+    outputWeights[order] = weights[order][intValueZero] * (1 - fractionalValue) + weights[order][intValueOne] * fractionalValue;
+    outputDiffuseWeights[order] = diffuseWeights[order][intValueZero] * (1 - fractionalValue) + diffuseWeights[order][intValueOne] * fractionalValue;
+  }
+}
@@ -0,0 +1,22 @@
+//-----------------------------------------------------------------------------
+// SpreadTable.h
+// The SpreadTable class precomputes the per-order weights that widen a point
+// source into a uniform spherical cap, as a function of the spread angle.
+// © 2026, ambiEncoder contributors. Some rights reserved.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+typedef int int32;
+typedef unsigned int uint32;
+
+class SpreadTable {
+public:
+  SpreadTable(uint32 inputTableLength);
+  ~SpreadTable();
+  void getWeights(double inputSpread, double* outputWeights, double* outputDiffuseWeights);
+private:
+  double** weights;
+  double** diffuseWeights;
+  uint32 tableLength;
+};
@@ -30,6 +30,7 @@
 #include "ambiEncoderIDs.h"
 #include "pluginterfaces/base/ustring.h"
 #include "pluginterfaces/base/ibstream.h"
+#include "pluginterfaces/vst/ivstmessage.h"
 
 namespace Steinberg {
 namespace Vst {
@@ -48,10 +49,93 @@ tresult PLUGIN_API ambiEncoderController::initialize(FUnknown* context) {
 		param = new RangeParameter(USTRING("Elevation (phi)"), kPhi, USTRING("deg."), -90.0, 90.0, 0.0);
 		param->setPrecision(1);
 		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Priority"), kPriority, USTRING("%"), 0.0, 100.0, 100.0);
+		param->setPrecision(0);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Distance model"), kDistanceModel, USTRING(""), 0, 1, 0);
+		param->setPrecision(0);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Distance"), kDistance, USTRING("m"), 0.1, 100.0, 0.1);
+		param->setPrecision(1);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Spread"), kSpread, USTRING("deg."), 0.0, 180.0, 0.0);
+		param->setPrecision(1);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Decorrelate"), kDecorrelate, USTRING(""), 0, 1, 0);
+		param->setPrecision(0);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Capture"), kCapture, USTRING(""), 0, 1, 0, 0, 0);
+		param->setPrecision(0);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Capture overruns"), kCaptureOverruns, USTRING(""), 0, 1000, 0, 0, ParameterInfo::kIsReadOnly);
+		param->setPrecision(0);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Capture running"), kCaptureRunning, USTRING(""), 0, 1, 0, 0, ParameterInfo::kIsReadOnly);
+		param->setPrecision(0);
+		parameters.addParameter(param);
+		StringListParameter* busParam = new StringListParameter(USTRING("Scene bus"), kBusMode, nullptr, ParameterInfo::kIsList);
+		busParam->appendString(USTRING("Off"));
+		busParam->appendString(USTRING("Send"));
+		busParam->appendString(USTRING("Collect"));
+		parameters.addParameter(busParam);
+		param = new RangeParameter(USTRING("Near-field compensation"), kNearField, USTRING(""), 0, 1, 0);
+		param->setPrecision(0);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Reference radius"), kReferenceRadius, USTRING("m"), 0.5, 10.0, 2.0);
+		param->setPrecision(2);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Early reflections"), kReflections, USTRING(""), 0, 1, 0);
+		param->setPrecision(0);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Room length"), kRoomLength, USTRING("m"), 2.0, 30.0, 8.0);
+		param->setPrecision(1);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Room width"), kRoomWidth, USTRING("m"), 2.0, 30.0, 6.0);
+		param->setPrecision(1);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Room height"), kRoomHeight, USTRING("m"), 2.0, 30.0, 3.0);
+		param->setPrecision(1);
+		parameters.addParameter(param);
+		param = new RangeParameter(USTRING("Wall reflection"), kWallReflection, USTRING(""), 0.0, 1.0, 0.7);
+		param->setPrecision(2);
+		parameters.addParameter(param);
   }
   return kResultTrue;
 }
 
+//------------------------------------------------------------------------
+tresult PLUGIN_API ambiEncoderController::setParamNormalized(ParamID tag, ParamValue value) {
+  bool wasCapturing = tag == kCapture && getParamNormalized(kCapture) > 0.5;
+  int32 previousBusMode = tag == kBusMode ? (int32) (getParamNormalized(kBusMode) * kBusCollect + 0.5) : kBusOff;
+  // the previous values are read before the base class stores the new ones
+  tresult result = EditController::setParamNormalized(tag, value);
+  if (tag == kCapture && result == kResultTrue && wasCapturing != (value > 0.5)) {
+    // the processor opens the capture file on the message thread, never on the audio thread
+    IMessage* message = allocateMessage();
+    if (message) {
+      message->setMessageID(kCaptureMessage);
+      message->getAttributes()->setInt(kCaptureAttribute, value > 0.5 ? 1 : 0);
+      sendMessage(message);
+      message->release();
+    }
+  }
+  int32 busMode = (int32) (value * kBusCollect + 0.5);
+  if (tag == kBusMode && result == kResultTrue && busMode != previousBusMode) {
+    // the processor claims its bus slot on the message thread; collecting adds one block of latency
+    IMessage* message = allocateMessage();
+    if (message) {
+      message->setMessageID(kBusModeMessage);
+      message->getAttributes()->setInt(kBusModeAttribute, busMode);
+      sendMessage(message);
+      message->release();
+    }
+    if (componentHandler) {
+      componentHandler->restartComponent(kLatencyChanged);
+    }
+  }
+  return result;
+}
+
 //------------------------------------------------------------------------
 tresult PLUGIN_API ambiEncoderController::setComponentState(IBStream* state) {
   // we receive the current state of the component (processor part)
@@ -85,6 +169,136 @@ tresult PLUGIN_API ambiEncoderController::setComponentState(IBStream* state) {
 		SWAP_32(phiState)
 #endif
 		setParamNormalized(kPhi, phiState * 2.0 + 0.5);
+
+		float priorityState = 1.0;
+		if (state->read(&priorityState, sizeof(float)) != kResultOk) {
+			// could be an old version, stop here
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(priorityState)
+#endif
+		setParamNormalized(kPriority, priorityState);
+
+		float reservedState = 1.0;
+		if (state->read(&reservedState, sizeof(float)) != kResultOk) {
+			return kResultOk;
+		}
+		// the order budget is a process-wide setting, the field is only skipped
+
+		float distanceState = 0.0;
+		if (state->read(&distanceState, sizeof(float)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(distanceState)
+#endif
+		setParamNormalized(kDistance, distanceState);
+
+		float spreadState = 0.0;
+		if (state->read(&spreadState, sizeof(float)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(spreadState)
+#endif
+		setParamNormalized(kSpread, spreadState);
+
+		int32 decorrelateState = 0;
+		if (state->read(&decorrelateState, sizeof(int32)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(decorrelateState)
+#endif
+		setParamNormalized(kDecorrelate, decorrelateState ? 1 : 0);
+
+		int32 reservedCaptureState = 0;
+		if (state->read(&reservedCaptureState, sizeof(int32)) != kResultOk) {
+			return kResultOk;
+		}
+		// capture is armed by message and is never restored from a state
+
+		int32 busModeState = kBusOff;
+		if (state->read(&busModeState, sizeof(int32)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(busModeState)
+#endif
+		setParamNormalized(kBusMode, (ParamValue) busModeState / kBusCollect);
+
+		int32 nearFieldState = 0;
+		if (state->read(&nearFieldState, sizeof(int32)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(nearFieldState)
+#endif
+		setParamNormalized(kNearField, nearFieldState ? 1 : 0);
+
+		float referenceRadiusState = 0.0;
+		if (state->read(&referenceRadiusState, sizeof(float)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(referenceRadiusState)
+#endif
+		setParamNormalized(kReferenceRadius, referenceRadiusState);
+
+		int32 reflectionsState = 0;
+		if (state->read(&reflectionsState, sizeof(int32)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(reflectionsState)
+#endif
+		setParamNormalized(kReflections, reflectionsState ? 1 : 0);
+
+		float roomLengthState = 0.0;
+		if (state->read(&roomLengthState, sizeof(float)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(roomLengthState)
+#endif
+		setParamNormalized(kRoomLength, roomLengthState);
+
+		float roomWidthState = 0.0;
+		if (state->read(&roomWidthState, sizeof(float)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(roomWidthState)
+#endif
+		setParamNormalized(kRoomWidth, roomWidthState);
+
+		float roomHeightState = 0.0;
+		if (state->read(&roomHeightState, sizeof(float)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(roomHeightState)
+#endif
+		setParamNormalized(kRoomHeight, roomHeightState);
+
+		float wallReflectionState = 0.0;
+		if (state->read(&wallReflectionState, sizeof(float)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(wallReflectionState)
+#endif
+		setParamNormalized(kWallReflection, wallReflectionState);
+
+		int32 distanceModelState = 0;
+		if (state->read(&distanceModelState, sizeof(int32)) != kResultOk) {
+			return kResultOk;
+		}
+#if BYTEORDER == kBigEndian
+		SWAP_32(distanceModelState)
+#endif
+		setParamNormalized(kDistanceModel, distanceModelState ? 1 : 0);
 	}
 
   return kResultOk;
@@ -45,6 +45,8 @@ public:
   //---from IPluginBase--------
   tresult PLUGIN_API initialize(FUnknown* context) SMTG_OVERRIDE;
   tresult PLUGIN_API setComponentState(IBStream* state) SMTG_OVERRIDE;
+  //---from EditController-----
+  tresult PLUGIN_API setParamNormalized(ParamID tag, ParamValue value) SMTG_OVERRIDE;
 };
 
 } // namespace Vst
@@ -35,9 +35,38 @@ namespace Vst {
 enum {
   kBypass = 100,
   kTheta = 101,
-  kPhi = 102
+  kPhi = 102,
+  kPriority = 103,
+  kDistance = 105,
+  kSpread = 106,
+  kDecorrelate = 107,
+  kCapture = 108,
+  kCaptureOverruns = 109,
+  kBusMode = 110,
+  kNearField = 111,
+  kReferenceRadius = 112,
+  kReflections = 113,
+  kRoomLength = 114,
+  kRoomWidth = 115,
+  kRoomHeight = 116,
+  kWallReflection = 117,
+  kDistanceModel = 118,
+  kCaptureRunning = 119
 };
 
+// scene bus modes
+enum {
+  kBusOff = 0,
+  kBusSend = 1,
+  kBusCollect = 2
+};
+
+// controller to processor messages
+static const char* const kCaptureMessage = "Capture";
+static const char* const kCaptureAttribute = "Active";
+static const char* const kBusModeMessage = "SceneBus";
+static const char* const kBusModeAttribute = "Mode";
+
 // unique class ids
 static const FUID ambiEncoderProcessorUID(0x48CF92CC, 0xB8E445EC, 0xACA2610D, 0x10B69E01);
 static const FUID ambiEncoderControllerUID(0xCA86B6C2, 0x27A34905, 0xB98CB9D7, 0xBABA87A1);
@@ -31,19 +31,138 @@
 #include "pluginterfaces/base/ustring.h"
 #include "pluginterfaces/base/ibstream.h"
 #include "pluginterfaces/vst/ivstparameterchanges.h"
+#include "pluginterfaces/vst/ivstmessage.h"
 #include "Encoder.h"
 #include "Ramp.h"
+#include "OrderBudget.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 
 namespace Steinberg {
 namespace Vst {
 
 //-----------------------------------------------------------------------------
-ambiEncoderProcessor::ambiEncoderProcessor(): bypass(true), theta(0.0), phi(0.0) {
+static const double MIN_DISTANCE = 0.1;
+static const double MAX_DISTANCE = 100.0;
+static const double REFERENCE_DISTANCE = 1.0;
+static const double SPEED_OF_SOUND = 343.0;
+
+//-----------------------------------------------------------------------------
+static double distanceMeters(ParamValue normalizedDistance) {
+  return MIN_DISTANCE + normalizedDistance * (MAX_DISTANCE - MIN_DISTANCE);
+}
+
+//-----------------------------------------------------------------------------
+static double referenceRadiusMeters(ParamValue normalizedRadius) {
+  return 0.5 + normalizedRadius * 9.5;
+}
+
+//-----------------------------------------------------------------------------
+static double roomMeters(ParamValue normalizedSize) {
+  return 2.0 + normalizedSize * 28.0;
+}
+
+//-----------------------------------------------------------------------------
+static double absorptionCutoff(double meters) {
+  // APPROSSIMAZIONE GROSSOLANA DELL'ASSORBIMENTO DELL'ARIA: CIRCA 3.3 kHz A 100 METRI...
+  return 20000.0 / (1.0 + 0.05 * meters);
+}
+
+//-----------------------------------------------------------------------------
+static void capturePath(char* output, size_t outputSize, const void* instance) {
+  const char* directory = getenv("AMBIENCODER_CAPTURE_DIR");
+  if (!directory) {
+    directory = getenv("TMPDIR");
+  }
+  if (!directory) {
+    directory = getenv("TEMP");
+  }
+  if (!directory) {
+    directory = "/tmp";
+  }
+  snprintf(output, outputSize, "%s/ambiEncoder-%ld-%p.wav", directory, (long) time(nullptr), instance);
+}
+
+//-----------------------------------------------------------------------------
+ambiEncoderProcessor::ambiEncoderProcessor(): bypass(true), distanceModel(false), decorrelate(false), capture(false), nearField(false), reflections(false), theta(0.0), phi(0.0),
+                                              priority(1.0), distance(0.0), spread(0.0), referenceRadius(1.5 / 9.5),
+                                              roomLength(6.0 / 28.0), roomWidth(4.0 / 28.0), roomHeight(1.0 / 28.0), wallReflection(0.7),
+                                              budgetSlot(-1), busOrder(Encoder::MAX_ORDER), distanceModelGain(0.0),
+                                              delayLine(nullptr), delayTimes(nullptr), distanceGains(nullptr),
+                                              sourceSamples(nullptr), maxBlockSize(0), previousSpread(-1.0), decorrelateGain(0.0),
+                                              captureWriter(nullptr), isPushing(false), activeChannels(0), reportedOverruns(0), reportedCapturing(false), busMode(kBusOff), effectiveBusMode(kBusOff), busSlot(-1), isPublishing(false), isCollector(false), busTime(0),
+                                              nearFieldGain(0.0), reflectionSamples(nullptr), weightedReflectionSamples(nullptr) {
   setControllerClass(ambiEncoderControllerUID);
   encoder = new Encoder(2048);
   encoder->initCoordinates(theta, phi);
   thetaSmoother = new Ramp(128);
   phiSmoother = new Ramp(128);
+  orderGains[0] = 1.0;
+  for (uint32 order = 1; order <= Encoder::MAX_ORDER; order++) {
+    orderSmoothers[order - 1] = new Ramp(64);
+    orderGains[order] = 0.0;
+  }
+  // DISSOLVENZE BREVI PER OGNI ORDINE, DI DURATA 2^N...
+  distanceSmoother = new Ramp(512);
+  distanceModelSmoother = new Ramp(64);
+  airAbsorption = new OnePole();
+  spreadSmoother = new Ramp(128);
+  decorrelateSmoother = new Ramp(64);
+  spreadTable = new SpreadTable(1024);
+  for (uint32 channelOut = 1; channelOut < Encoder::MAX_CHANNELS; channelOut++) {
+    decorrelators[channelOut - 1] = new Decorrelator(channelOut - 1);
+  }
+  encoder->getDiffuseCoefficients(diffuseCoefficients);
+  // UN DECORRELATORE PER OGNI CANALE DIREZIONALE: LA COMPONENTE DIFFUSA NON HA UNA DIREZIONE...
+  nearFieldFilter = new NearFieldFilter();
+  nearFieldSmoother = new Ramp(64);
+  imageSources = new ImageSourceModel();
+  for (uint32 i = 0; i < ImageSourceModel::MAX_REFLECTIONS; i++) {
+    reflectionDelays[i] = 0.0;
+    reflectionGains[i] = 0.0;
+    for (uint32 channelOut = 0; channelOut < Encoder::MAX_CHANNELS; channelOut++) {
+      reflectionCoefficients[i][channelOut] = 0.0;
+      targetReflectionCoefficients[i][channelOut] = 0.0;
+    }
+  }
+  for (uint32 order = 1; order <= Encoder::MAX_ORDER; order++) {
+    orderGainSamples[order - 1] = nullptr;
+  }
+}
+
+//-----------------------------------------------------------------------------
+ambiEncoderProcessor::~ambiEncoderProcessor() {
+  delete encoder;
+  delete thetaSmoother;
+  delete phiSmoother;
+  for (uint32 order = 1; order <= Encoder::MAX_ORDER; order++) {
+    delete orderSmoothers[order - 1];
+  }
+  delete distanceSmoother;
+  delete distanceModelSmoother;
+  delete airAbsorption;
+  delete spreadSmoother;
+  delete decorrelateSmoother;
+  delete spreadTable;
+  for (uint32 channelOut = 1; channelOut < Encoder::MAX_CHANNELS; channelOut++) {
+    delete decorrelators[channelOut - 1];
+  }
+  delete delayLine;
+  delete[] delayTimes;
+  delete[] distanceGains;
+  delete[] sourceSamples;
+  disarmCapture();
+  releaseBus();
+  delete nearFieldFilter;
+  delete nearFieldSmoother;
+  delete imageSources;
+  delete[] reflectionSamples;
+  delete[] weightedReflectionSamples;
+  for (uint32 order = 1; order <= Encoder::MAX_ORDER; order++) {
+    delete[] orderGainSamples[order - 1];
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -52,15 +171,27 @@ tresult PLUGIN_API ambiEncoderProcessor::initialize(FUnknown* context) {
   if (result == kResultTrue) {
     addAudioInput(USTRING("AudioInput"), SpeakerArr::kMono);
     addAudioOutput(USTRING("AudioOutput"), SpeakerArr::kBFormat3rdOrder);
+    budgetSlot = OrderBudget::getInstance().registerSource();
+    OrderBudget::getInstance().setPriority(budgetSlot, (float) priority);
   }
   return result;
 }
 
+//-----------------------------------------------------------------------------
+tresult PLUGIN_API ambiEncoderProcessor::terminate() {
+  OrderBudget::getInstance().unregisterSource(budgetSlot);
+  budgetSlot = -1;
+  return AudioEffect::terminate();
+}
+
 //-----------------------------------------------------------------------------
 tresult PLUGIN_API ambiEncoderProcessor::setBusArrangements(SpeakerArrangement* inputs, int32 numIns, SpeakerArrangement* outputs, int32 numOuts) {
-  // we only support one in and output bus and these buses must have the same number of channels
-  if (numIns == 1 && numOuts == 1 && inputs[0] == SpeakerArr::kMono && outputs[0] == SpeakerArr::kBFormat3rdOrder) {
-    return AudioEffect::setBusArrangements (inputs, numIns, outputs, numOuts);
+  // we only support one mono input bus and one B-format output bus of 1st, 2nd or 3rd order
+  if (numIns == 1 && numOuts == 1 && inputs[0] == SpeakerArr::kMono) {
+    if (outputs[0] == SpeakerArr::kBFormat1stOrder || outputs[0] == SpeakerArr::kBFormat2ndOrder ||
+        outputs[0] == SpeakerArr::kBFormat3rdOrder) {
+      return AudioEffect::setBusArrangements (inputs, numIns, outputs, numOuts);
+    }
   }
   return kResultFalse;
 }
@@ -75,9 +206,161 @@ tresult PLUGIN_API ambiEncoderProcessor::setActive(TBool state) {
   if (numChannels == 0) {
     return kResultFalse;
   }
+  uint32 order = 0;
+  while (order < Encoder::MAX_ORDER && (int32) Encoder::getChannelCount(order) < numChannels) {
+    order++;
+  }
+  if ((int32) Encoder::getChannelCount(order) != numChannels) {
+    return kResultFalse;
+  }
+  busOrder = order;
+  encoder->setOrder(busOrder);
+  OrderBudget::getInstance().setMaxOrder(budgetSlot, busOrder);
+  // L'ORDINE DEL BUS DI USCITA LIMITA I CANALI CALCOLATI DALL'ENCODER...
+  delete delayLine;
+  delete[] delayTimes;
+  delete[] distanceGains;
+  delete[] sourceSamples;
+  delete[] reflectionSamples;
+  delete[] weightedReflectionSamples;
+  for (uint32 order = 1; order <= Encoder::MAX_ORDER; order++) {
+    delete[] orderGainSamples[order - 1];
+    orderGainSamples[order - 1] = nullptr;
+  }
+  disarmCapture();
+  activeChannels = 0;
+  releaseBus();
+  delayLine = nullptr;
+  delayTimes = nullptr;
+  distanceGains = nullptr;
+  sourceSamples = nullptr;
+  reflectionSamples = nullptr;
+  weightedReflectionSamples = nullptr;
+  maxBlockSize = 0;
+  imageSources->reset();
+  for (uint32 i = 0; i < ImageSourceModel::MAX_REFLECTIONS; i++) {
+    reflectionGains[i] = 0.0;
+  }
+  // I COEFFICIENTI DELLE RIFLESSIONI DIPENDONO DALL'ORDINE DEL BUS, VANNO RICALCOLATI...
+  if (state) {
+    maxBlockSize = processSetup.maxSamplesPerBlock;
+    uint32 maxDelay = (uint32) (MAX_DISTANCE / SPEED_OF_SOUND * processSetup.sampleRate) + DelayLine::MIN_DELAY + 1;
+    delayLine = new DelayLine(maxDelay, maxBlockSize);
+    delayTimes = new double[maxBlockSize];
+    distanceGains = new double[maxBlockSize];
+    sourceSamples = new double[maxBlockSize];
+    reflectionSamples = new double[maxBlockSize];
+    weightedReflectionSamples = new double[maxBlockSize];
+    for (uint32 order = 1; order <= Encoder::MAX_ORDER; order++) {
+      orderGainSamples[order - 1] = new double[maxBlockSize];
+    }
+    airAbsorption->clear();
+    for (uint32 channelOut = 1; channelOut < Encoder::MAX_CHANNELS; channelOut++) {
+      decorrelators[channelOut - 1]->clear();
+    }
+    nearFieldFilter->clear();
+    activeChannels = numChannels;
+    if (capture) {
+      armCapture();
+    }
+    applyBusMode();
+  }
+  // I BUFFER DIPENDONO DALLA FREQUENZA DI CAMPIONAMENTO E DALLA DIMENSIONE MASSIMA DEL BLOCCO...
   return AudioEffect::setActive(state);
 }
 
+//-----------------------------------------------------------------------------
+tresult PLUGIN_API ambiEncoderProcessor::notify(IMessage* message) {
+  if (message && !strcmp(message->getMessageID(), kCaptureMessage)) {
+    int64 active = 0;
+    if (message->getAttributes()->getInt(kCaptureAttribute, active) == kResultOk) {
+      capture = active != 0;
+      if (capture) {
+        armCapture();
+      } else {
+        disarmCapture();
+      }
+    }
+    return kResultOk;
+  }
+  if (message && !strcmp(message->getMessageID(), kBusModeMessage)) {
+    int64 mode = kBusOff;
+    if (message->getAttributes()->getInt(kBusModeAttribute, mode) == kResultOk && mode != busMode) {
+      busMode = (int32) mode;
+      applyBusMode();
+    }
+    return kResultOk;
+  }
+  // IL MESSAGGIO ARRIVA DAL CONTROLLER FUORI DAL THREAD AUDIO: QUI SI PUO' APRIRE IL FILE...
+  return AudioEffect::notify(message);
+}
+
+//-----------------------------------------------------------------------------
+uint32 PLUGIN_API ambiEncoderProcessor::getLatencySamples() {
+  return effectiveBusMode.load() == kBusCollect ? (uint32) maxBlockSize : 0;
+}
+
+//-----------------------------------------------------------------------------
+void ambiEncoderProcessor::applyBusMode() {
+  releaseBus();
+  if (activeChannels == 0 || busMode == kBusOff) {
+    return;
+  }
+  if (busMode == kBusCollect) {
+    isCollector = SceneBus::getInstance().acquireCollector();
+    if (!isCollector) {
+      return;
+    }
+  }
+  // UN SOLO COLLETTORE PER PROCESSO: IL SECONDO RESTA SULL'USCITA NORMALE...
+  int32 slot = SceneBus::getInstance().registerSlot(activeChannels, maxBlockSize);
+  if (slot < 0) {
+    releaseBus();
+    return;
+  }
+  // SLOT ESAURITI: LA SORGENTE RESTA SULL'USCITA NORMALE INVECE DI SPARIRE...
+  effectiveBusMode.store(busMode);
+  busSlot.store(slot);
+}
+
+//-----------------------------------------------------------------------------
+void ambiEncoderProcessor::releaseBus() {
+  int32 slot = busSlot.exchange(-1);
+  effectiveBusMode.store(kBusOff);
+  while (isPublishing.load()) {
+    // IL THREAD AUDIO STA ANCORA USANDO LO SLOT...
+  }
+  SceneBus::getInstance().unregisterSlot(slot);
+  if (isCollector) {
+    SceneBus::getInstance().releaseCollector();
+    isCollector = false;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ambiEncoderProcessor::armCapture() {
+  if (activeChannels == 0 || captureWriter.load()) {
+    return;
+  }
+  char path[1024];
+  capturePath(path, sizeof(path), this);
+  CaptureWriter* writer = new CaptureWriter(activeChannels, processSetup.sampleRate, 2.0);
+  if (!writer->start(path)) {
+    delete writer;
+    return;
+  }
+  captureWriter.store(writer);
+}
+
+//-----------------------------------------------------------------------------
+void ambiEncoderProcessor::disarmCapture() {
+  CaptureWriter* writer = captureWriter.exchange(nullptr);
+  while (isPushing.load()) {
+    // IL THREAD AUDIO STA ANCORA COPIANDO L'ULTIMO BLOCCO...
+  }
+  delete writer;
+}
+
 //-----------------------------------------------------------------------------
 tresult PLUGIN_API ambiEncoderProcessor::process(ProcessData& data) {
   if (data.inputParameterChanges) {
@@ -103,37 +386,323 @@ tresult PLUGIN_API ambiEncoderProcessor::process(ProcessData& data) {
             phi = value * 0.5 - 0.25;
           }
           break;
+        case kPriority:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            priority = value;
+            OrderBudget::getInstance().setPriority(budgetSlot, (float) priority);
+          }
+          break;
+        case kDistance:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            distance = value;
+          }
+          break;
+        case kDistanceModel:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            distanceModel = (value > 0.5);
+          }
+          break;
+        case kSpread:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            spread = value;
+          }
+          break;
+        case kDecorrelate:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            decorrelate = (value > 0.5);
+          }
+          break;
+        case kNearField:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            nearField = (value > 0.5);
+          }
+          break;
+        case kReferenceRadius:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            referenceRadius = value;
+          }
+          break;
+        case kReflections:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            reflections = (value > 0.5);
+          }
+          break;
+        case kRoomLength:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            roomLength = value;
+          }
+          break;
+        case kRoomWidth:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            roomWidth = value;
+          }
+          break;
+        case kRoomHeight:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            roomHeight = value;
+          }
+          break;
+        case kWallReflection:
+          if (paramQueue->getPoint(numPoints - 1,  sampleOffset, value) == kResultTrue) {
+            wallReflection = value;
+          }
+          break;
         }
       }
     }
   }
 
+  if (data.numSamples > maxBlockSize) {
+    return kResultFalse;
+  }
+
   if (data.numSamples > 0) {
-    SpeakerArrangement inArr;
-    getBusArrangement(kInput, 0, inArr);
-    int32 numInChannels = SpeakerArr::getChannelCount(inArr);
+    SpeakerArrangement outArr;
+    getBusArrangement(kOutput, 0, outArr);
+    int32 numOutChannels = SpeakerArr::getChannelCount(outArr);
 
-    int32 numOutChannels;
-    if (bypass) {
-      numOutChannels = numInChannels;
+    uint32 targetOrder = 0;
+    if (!bypass) {
+      targetOrder = OrderBudget::getInstance().getOrder(budgetSlot);
+      targetOrder = targetOrder < busOrder ? targetOrder : busOrder;
+    }
+    uint32 activeOrder = targetOrder;
+    for (uint32 order = targetOrder + 1; order <= busOrder; order++) {
+      if (orderGains[order] > 0.0) {
+        activeOrder = order;
+      }
+    }
+    // UN ORDINE RIMOSSO RESTA ATTIVO FINCHE' LA SUA DISSOLVENZA NON E' CONCLUSA...
+    int32 numActiveChannels = Encoder::getChannelCount(activeOrder);
+    Encoder::Kernel encodeKernel = Encoder::getKernel(activeOrder);
+
+    float* inputChannel = data.inputs[0].channelBuffers32[0];
+    float** outputChannels = data.outputs[0].channelBuffers32;
+    double samplesPerMeter = processSetup.sampleRate / SPEED_OF_SOUND;
+    double targetDistance = distanceMeters(distance);
+    double smoothedDistance = targetDistance;
+    for (int32 sample = 0; sample < data.numSamples; sample++) {
+      smoothedDistance = distanceSmoother->oneSampleProcessor(targetDistance);
+      delayTimes[sample] = smoothedDistance * samplesPerMeter;
+      distanceGains[sample] = REFERENCE_DISTANCE / (smoothedDistance > REFERENCE_DISTANCE ? smoothedDistance : REFERENCE_DISTANCE);
+    }
+    // RITARDO E GUADAGNO SEGUONO LA STESSA RAMPA, IL VARIARE DEL RITARDO PRODUCE L'EFFETTO DOPPLER...
+    bool isDistanceModel = distanceModel && !bypass;
+    bool isReflections = reflections && !bypass;
+    // IN BYPASS IL MODELLO DI DISTANZA E LE RIFLESSIONI SI SPENGONO CON LE LORO DISSOLVENZE, COME GLI ORDINI...
+    delayLine->write(inputChannel, data.numSamples);
+    // LA LINEA DI RITARDO VIENE SEMPRE SCRITTA, COSI' ALL'ATTIVAZIONE DEL MODELLO CONTIENE GIA' IL SEGNALE...
+    if (isDistanceModel || distanceModelGain > 0.0) {
+      if (distanceModelGain == 0.0) {
+        airAbsorption->clear();
+      }
+      delayLine->read(delayTimes, sourceSamples, data.numSamples);
+      airAbsorption->setCutoff(absorptionCutoff(smoothedDistance), processSetup.sampleRate);
+      for (int32 sample = 0; sample < data.numSamples; sample++) {
+        double distanceSample = airAbsorption->oneSampleProcessor(sourceSamples[sample]) * distanceGains[sample];
+        distanceModelGain = distanceModelSmoother->oneSampleProcessor(isDistanceModel ? 1.0 : 0.0);
+        sourceSamples[sample] = inputChannel[sample] + (distanceSample - inputChannel[sample]) * distanceModelGain;
+      }
+      // DISSOLVENZA TRA IL SEGNALE DIRETTO E QUELLO RITARDATO E FILTRATO...
     } else {
-      SpeakerArrangement outArr;
-      getBusArrangement(kOutput, 0, outArr);
-      numOutChannels = SpeakerArr::getChannelCount(outArr);
+      for (int32 sample = 0; sample < data.numSamples; sample++) {
+        sourceSamples[sample] = inputChannel[sample];
+      }
+      // MODELLO DISATTIVO: NESSUN RITARDO, NESSUN FILTRO, GUADAGNO UNITARIO...
     }
+    if (nearField || nearFieldGain > 0.0) {
+      if (nearFieldGain == 0.0) {
+        nearFieldFilter->clear();
+      }
+      // IL FILTRO RIPARTE DA ZERO, SENZA LO STATO RIMASTO DALL'ULTIMO UTILIZZO...
+      nearFieldFilter->setDistance(smoothedDistance, referenceRadiusMeters(referenceRadius), processSetup.sampleRate);
+    }
+    // I COEFFICIENTI DEL FILTRO DI CAMPO VICINO SEGUONO LA DISTANZA UNA VOLTA PER BLOCCO, SOLO SE CAMBIA...
 
-    for (int32 channelIn = 0; channelIn < numInChannels; channelIn++) {
-      float* inputChannel = data.inputs[0].channelBuffers32[channelIn];
-      for (int32 channelOut = 0; channelOut < numOutChannels; channelOut++) {
-        float* outputChannel = data.outputs[0].channelBuffers32[channelOut];
-        for (int32 sample = 0; sample < data.numSamples; sample++) {
-          float smoothedTheta = (float) thetaSmoother->oneSampleProcessor(theta);
-          float smoothedPhi = (float) phiSmoother->oneSampleProcessor(phi);
-          encoder->changeCoordinates(smoothedTheta, smoothedPhi);
-          outputChannel[sample] = encoder->oneSampleProcessor(inputChannel[sample], channelOut);
+    if (decorrelate && decorrelateGain == 0.0) {
+      for (uint32 channelOut = 1; channelOut < Encoder::MAX_CHANNELS; channelOut++) {
+        decorrelators[channelOut - 1]->clear();
+      }
+    }
+    // I DECORRELATORI FERMI DA TEMPO CONTENGONO UNO STATO VECCHIO, RIPARTONO DA ZERO...
+    double blockTheta = theta;
+    double blockPhi = phi;
+    for (int32 sample = 0; sample < data.numSamples; sample++) {
+      float smoothedTheta = (float) thetaSmoother->oneSampleProcessor(theta);
+      float smoothedPhi = (float) phiSmoother->oneSampleProcessor(phi);
+      blockTheta = smoothedTheta;
+      blockPhi = smoothedPhi;
+      encoder->changeCoordinates(smoothedTheta, smoothedPhi);
+      double smoothedSpread = spreadSmoother->oneSampleProcessor(spread);
+      if (smoothedSpread != previousSpread) {
+        spreadTable->getWeights(smoothedSpread, spreadWeights, diffuseWeights);
+        previousSpread = smoothedSpread;
+      }
+      // I PESI DI DIFFUSIONE SI APPLICANO PER ORDINE, QUINDI UNA SORGENTE AMPIA COSTA COME UNA PUNTIFORME...
+      for (uint32 order = 1; order <= busOrder; order++) {
+        orderGains[order] = orderSmoothers[order - 1]->oneSampleProcessor(order <= targetOrder ? 1.0 : 0.0);
+        orderGainSamples[order - 1][sample] = orderGains[order];
+      }
+      decorrelateGain = decorrelateSmoother->oneSampleProcessor(decorrelate ? 1.0 : 0.0);
+      double orderSamples[Encoder::MAX_ORDER + 1] = {0.0, 0.0, 0.0, 0.0};
+      for (uint32 order = 0; order <= activeOrder; order++) {
+        orderSamples[order] = sourceSamples[sample] * spreadWeights[order];
+      }
+      nearFieldGain = nearFieldSmoother->oneSampleProcessor(nearField ? 1.0 : 0.0);
+      if (nearFieldGain > 0.0 && activeOrder > 0) {
+        double filteredSamples[Encoder::MAX_ORDER + 1] = {orderSamples[0], orderSamples[1], orderSamples[2], orderSamples[3]};
+        nearFieldFilter->oneSampleProcessor(filteredSamples);
+        for (uint32 order = 1; order <= activeOrder; order++) {
+          orderSamples[order] += (filteredSamples[order] - orderSamples[order]) * nearFieldGain;
+        }
+      }
+      // L'ATTIVAZIONE E LA DISATTIVAZIONE DEL FILTRO SONO DISSOLVENZE: IL FILTRO PUO' ENFATIZZARE MOLTO I BASSI...
+      // IL FILTRO AGISCE SUL SEGNALE DI CIASCUN ORDINE, PRIMA DEI GUADAGNI DEI SINGOLI CANALI...
+      for (uint32 order = 0; order <= activeOrder; order++) {
+        orderSamples[order] *= orderGains[order];
+      }
+      (encoder->*encodeKernel)(orderSamples, outputChannels, sample);
+      if (decorrelateGain > 0.0) {
+        for (uint32 order = 1; order <= activeOrder; order++) {
+          double diffuseGain = diffuseWeights[order] * decorrelateGain * orderGains[order];
+          for (uint32 channelOut = order * order; channelOut < Encoder::getChannelCount(order); channelOut++) {
+            double diffuseSample = decorrelators[channelOut - 1]->oneSampleProcessor(sourceSamples[sample]);
+            outputChannels[channelOut][sample] += (float) (diffuseSample * diffuseCoefficients[channelOut] * diffuseGain);
+          }
+        }
+      }
+      // LA COMPONENTE DIFFUSA NON PASSA PER I COEFFICIENTI DELLA SORGENTE: OGNI CANALE HA IL SUO DECORRELATORE
+      // E IL GUADAGNO MEDIO DI UN CAMPO DIFFUSO, QUINDI L'ENERGIA RESTITUITA NON PUNTA VERSO LA SORGENTE...
+    }
+    for (int32 channelOut = numActiveChannels; channelOut < numOutChannels; channelOut++) {
+      memset(outputChannels[channelOut], 0, data.numSamples * sizeof(float));
+    }
+    // I CANALI DEGLI ORDINI ESCLUSI NON VENGONO CALCOLATI...
+
+    bool isReflecting = isReflections;
+    for (uint32 i = 0; i < ImageSourceModel::MAX_REFLECTIONS; i++) {
+      if (reflectionGains[i] > 0.0) {
+        isReflecting = true;
+      }
+    }
+    // RIFLESSIONI DISATTIVE E GIA' SPENTE: NESSUN CALCOLO GEOMETRICO...
+    if (isReflecting && imageSources->update(blockTheta, blockPhi, smoothedDistance, roomMeters(roomLength), roomMeters(roomWidth), roomMeters(roomHeight), wallReflection)) {
+      for (uint32 i = 0; i < ImageSourceModel::MAX_REFLECTIONS; i++) {
+        encoder->getCoefficients(imageSources->getTheta(i), imageSources->getPhi(i), targetReflectionCoefficients[i]);
+      }
+    }
+    // LE IMMAGINI SEGUONO GLI ANGOLI GIA' LIVELLATI, E CAMBIANO SOLO QUANDO LA SORGENTE SI MUOVE...
+    double blockStep = 1.0 / data.numSamples;
+    double directDelay = smoothedDistance * samplesPerMeter * (1.0 - distanceModelGain);
+    double directGain = REFERENCE_DISTANCE / (smoothedDistance > REFERENCE_DISTANCE ? smoothedDistance : REFERENCE_DISTANCE);
+    // SENZA MODELLO DI DISTANZA IL SUONO DIRETTO NON HA RITARDO NE' ATTENUAZIONE: LE RIFLESSIONI
+    // GLI ARRIVANO DOPO DI (r - d) / c E SCALATE DI d / r, QUINDI SI TOGLIE CIO' CHE IL DIRETTO NON HA...
+    for (uint32 i = 0; i < ImageSourceModel::MAX_REFLECTIONS && isReflecting; i++) {
+      double reflectionDistance = imageSources->getDistance(i);
+      double targetDelay = reflectionDistance * samplesPerMeter - directDelay;
+      double targetGain = 0.0;
+      if (isReflections) {
+        double reflectionGain = REFERENCE_DISTANCE / (reflectionDistance > REFERENCE_DISTANCE ? reflectionDistance : REFERENCE_DISTANCE);
+        targetGain = imageSources->getGain(i) * (reflectionGain * distanceModelGain + reflectionGain / directGain * (1.0 - distanceModelGain));
+      }
+      if (reflectionGains[i] == 0.0) {
+        reflectionDelays[i] = targetDelay;
+        for (uint32 channelOut = 0; channelOut < Encoder::MAX_CHANNELS; channelOut++) {
+          reflectionCoefficients[i][channelOut] = targetReflectionCoefficients[i][channelOut];
+        }
+        if (targetGain == 0.0) {
+          continue;
+        }
+      }
+      // UNA RIFLESSIONE MUTA NON LEGGE LA LINEA DI RITARDO...
+      double delayStep = (targetDelay - reflectionDelays[i]) * blockStep;
+      double gainStep = (targetGain - reflectionGains[i]) * blockStep;
+      for (int32 sample = 0; sample < data.numSamples; sample++) {
+        delayTimes[sample] = reflectionDelays[i] + delayStep * (sample + 1);
+      }
+      delayLine->read(delayTimes, reflectionSamples, data.numSamples);
+      for (int32 sample = 0; sample < data.numSamples; sample++) {
+        reflectionSamples[sample] *= reflectionGains[i] + gainStep * (sample + 1);
+      }
+      reflectionDelays[i] = targetDelay;
+      reflectionGains[i] = targetGain;
+      // TUTTE LE RIFLESSIONI LEGGONO LA STESSA LINEA DI RITARDO, SCRITTA UNA SOLA VOLTA PER BLOCCO...
+      for (uint32 order = 0; order <= activeOrder; order++) {
+        const double* weightedSamples = reflectionSamples;
+        if (order > 0) {
+          const double* gains = orderGainSamples[order - 1];
+          for (int32 sample = 0; sample < data.numSamples; sample++) {
+            weightedReflectionSamples[sample] = reflectionSamples[sample] * gains[sample];
+          }
+          weightedSamples = weightedReflectionSamples;
+        }
+        for (uint32 channelOut = order * order; channelOut < Encoder::getChannelCount(order); channelOut++) {
+          double coefficient = reflectionCoefficients[i][channelOut];
+          double coefficientStep = (targetReflectionCoefficients[i][channelOut] - coefficient) * blockStep;
+          float* output = outputChannels[channelOut];
+          for (int32 sample = 0; sample < data.numSamples; sample++) {
+            output[sample] += (float) ((coefficient + coefficientStep * (sample + 1)) * weightedSamples[sample]);
+          }
+          reflectionCoefficients[i][channelOut] = targetReflectionCoefficients[i][channelOut];
+        }
+      }
+      // COEFFICIENTI INTERPOLATI LINEARMENTE NEL BLOCCO, COME RITARDO E GUADAGNO: NESSUN SALTO TRA UN BLOCCO E L'ALTRO...
+    }
+
+    isPushing.store(true);
+    CaptureWriter* writer = captureWriter.load();
+    uint32 overruns = reportedOverruns;
+    if (writer) {
+      writer->push(outputChannels, data.numSamples);
+      overruns = writer->getOverruns();
+    }
+    isPushing.store(false);
+    // IL FLAG VIENE ALZATO PRIMA DI LEGGERE IL PUNTATORE: disarmCapture NON PUO' DISTRUGGERE UN WRITER IN USO...
+    bool isCapturing = writer != nullptr;
+    if (data.outputParameterChanges) {
+      int32 queueIndex = 0;
+      int32 pointIndex = 0;
+      IParamValueQueue* paramQueue = nullptr;
+      if (isCapturing != reportedCapturing) {
+        paramQueue = data.outputParameterChanges->addParameterData(kCaptureRunning, queueIndex);
+        if (paramQueue) {
+          paramQueue->addPoint(0, isCapturing ? 1.0 : 0.0, pointIndex);
+          reportedCapturing = isCapturing;
+          overruns = isCapturing ? overruns : 0;
+        }
+      }
+      if (overruns != reportedOverruns) {
+        paramQueue = data.outputParameterChanges->addParameterData(kCaptureOverruns, queueIndex);
+        if (paramQueue) {
+          paramQueue->addPoint(0, overruns < 1000 ? overruns / 1000.0 : 1.0, pointIndex);
+          reportedOverruns = overruns;
         }
       }
     }
+
+    int64 blockTime = busTime;
+    if (data.processContext && (data.processContext->state & ProcessContext::kContTimeValid)) {
+      blockTime = data.processContext->continuousTimeSamples;
+    }
+    busTime = blockTime + data.numSamples;
+    // TUTTE LE ISTANZE DEVONO CONDIVIDERE LA STESSA BASE DEI TEMPI: QUELLA CONTINUA DELL'HOST...
+    isPublishing.store(true);
+    int32 slot = busSlot.load();
+    int32 mode = slot >= 0 ? effectiveBusMode.load() : (int32) kBusOff;
+    if (mode != kBusOff) {
+      SceneBus::getInstance().publish(slot, outputChannels, data.numSamples, blockTime);
+      for (int32 channelOut = 0; channelOut < numOutChannels; channelOut++) {
+        memset(outputChannels[channelOut], 0, data.numSamples * sizeof(float));
+      }
+      data.outputs[0].silenceFlags = ((uint64) 1 << numOutChannels) - 1;
+      // L'USCITA PASSA PER IL BUS CONDIVISO, L'HOST PUO' IGNORARE QUELLA DEL PLUG-IN...
+      if (mode == kBusCollect) {
+        SceneBus::getInstance().collect(outputChannels, numOutChannels, data.numSamples, blockTime - maxBlockSize);
+        data.outputs[0].silenceFlags = 0;
+        // IL COLLETTORE LEGGE UN BLOCCO INDIETRO, ANCHE LA PROPRIA SORGENTE: LA LATENZA E' FISSA E DICHIARATA...
+      }
+    }
+    isPublishing.store(false);
   }
   return kResultTrue;
 }
@@ -160,15 +729,122 @@ tresult PLUGIN_API ambiEncoderProcessor::setState(IBStream* state) {
     return kResultFalse;
   }
 
+  float savedPriority = 1.0;
+  if (state->read(&savedPriority, sizeof(float)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  float savedReserved = 1.0;
+  if (state->read(&savedReserved, sizeof(float)) != kResultOk) {
+    // could be an old version, continue
+  }
+  // IL BUDGET E' GLOBALE (AMBIENCODER_ORDER_BUDGET): IL CAMPO RESTA SOLO PER LA COMPATIBILITA' DEL FORMATO...
+
+  float savedDistance = 0.0;
+  if (state->read(&savedDistance, sizeof(float)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  float savedSpread = 0.0;
+  if (state->read(&savedSpread, sizeof(float)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  int32 savedDecorrelate = 0;
+  if (state->read(&savedDecorrelate, sizeof(int32)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  int32 savedReservedCapture = 0;
+  if (state->read(&savedReservedCapture, sizeof(int32)) != kResultOk) {
+    // could be an old version, continue
+  }
+  // LA CATTURA NON FA PARTE DELLO STATO: IL CAMPO RESTA SOLO PER LA COMPATIBILITA' DEL FORMATO...
+
+  int32 savedBusMode = kBusOff;
+  if (state->read(&savedBusMode, sizeof(int32)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  int32 savedNearField = 0;
+  if (state->read(&savedNearField, sizeof(int32)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  float savedReferenceRadius = 1.5 / 9.5;
+  if (state->read(&savedReferenceRadius, sizeof(float)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  int32 savedReflections = 0;
+  if (state->read(&savedReflections, sizeof(int32)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  float savedRoomLength = 6.0 / 28.0;
+  if (state->read(&savedRoomLength, sizeof(float)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  float savedRoomWidth = 4.0 / 28.0;
+  if (state->read(&savedRoomWidth, sizeof(float)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  float savedRoomHeight = 1.0 / 28.0;
+  if (state->read(&savedRoomHeight, sizeof(float)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  float savedWallReflection = 0.7;
+  if (state->read(&savedWallReflection, sizeof(float)) != kResultOk) {
+    // could be an old version, continue
+  }
+
+  int32 savedDistanceModel = 0;
+  if (state->read(&savedDistanceModel, sizeof(int32)) != kResultOk) {
+    // could be an old version, continue
+  }
+
 #if BYTEORDER == kBigEndian
   SWAP_32(savedBypass)
   SWAP_32(savedTheta)
   SWAP_32(savedPhi)
+  SWAP_32(savedPriority)
+  SWAP_32(savedDistance)
+  SWAP_32(savedSpread)
+  SWAP_32(savedDecorrelate)
+  SWAP_32(savedBusMode)
+  SWAP_32(savedNearField)
+  SWAP_32(savedReferenceRadius)
+  SWAP_32(savedReflections)
+  SWAP_32(savedRoomLength)
+  SWAP_32(savedRoomWidth)
+  SWAP_32(savedRoomHeight)
+  SWAP_32(savedWallReflection)
+  SWAP_32(savedDistanceModel)
 #endif
 
   bypass = savedBypass > 0;
   theta = savedTheta;
   phi = savedPhi;
+  priority = savedPriority;
+  distance = savedDistance;
+  spread = savedSpread;
+  decorrelate = savedDecorrelate > 0;
+  if (savedBusMode != busMode) {
+    busMode = savedBusMode;
+    applyBusMode();
+  }
+  nearField = savedNearField > 0;
+  referenceRadius = savedReferenceRadius;
+  reflections = savedReflections > 0;
+  roomLength = savedRoomLength;
+  roomWidth = savedRoomWidth;
+  roomHeight = savedRoomHeight;
+  wallReflection = savedWallReflection;
+  distanceModel = savedDistanceModel > 0;
+  OrderBudget::getInstance().setPriority(budgetSlot, (float) priority);
 
   return kResultOk;
 }
@@ -179,16 +855,60 @@ tresult PLUGIN_API ambiEncoderProcessor::getState(IBStream* state) {
   int32 toSaveBypass = bypass ? 1 : 0;
   float toSaveTheta = theta;
   float toSavePhi = phi;
+  float toSavePriority = priority;
+  float toSaveReserved = 1.0;
+  float toSaveDistance = distance;
+  float toSaveSpread = spread;
+  int32 toSaveDecorrelate = decorrelate ? 1 : 0;
+  int32 toSaveReservedCapture = 0;
+  int32 toSaveBusMode = busMode;
+  int32 toSaveNearField = nearField ? 1 : 0;
+  float toSaveReferenceRadius = referenceRadius;
+  int32 toSaveReflections = reflections ? 1 : 0;
+  float toSaveRoomLength = roomLength;
+  float toSaveRoomWidth = roomWidth;
+  float toSaveRoomHeight = roomHeight;
+  float toSaveWallReflection = wallReflection;
+  int32 toSaveDistanceModel = distanceModel ? 1 : 0;
 
 #if BYTEORDER == kBigEndian
   SWAP_32(toSaveBypass)
   SWAP_32(toSaveTheta)
   SWAP_32(toSavePhi)
+  SWAP_32(toSavePriority)
+  SWAP_32(toSaveReserved)
+  SWAP_32(toSaveDistance)
+  SWAP_32(toSaveSpread)
+  SWAP_32(toSaveDecorrelate)
+  SWAP_32(toSaveBusMode)
+  SWAP_32(toSaveNearField)
+  SWAP_32(toSaveReferenceRadius)
+  SWAP_32(toSaveReflections)
+  SWAP_32(toSaveRoomLength)
+  SWAP_32(toSaveRoomWidth)
+  SWAP_32(toSaveRoomHeight)
+  SWAP_32(toSaveWallReflection)
+  SWAP_32(toSaveDistanceModel)
 #endif
 
   state->write(&toSaveBypass, sizeof(int32));
   state->write(&toSaveTheta, sizeof(float));
   state->write(&toSavePhi, sizeof(float));
+  state->write(&toSavePriority, sizeof(float));
+  state->write(&toSaveReserved, sizeof(float));
+  state->write(&toSaveDistance, sizeof(float));
+  state->write(&toSaveSpread, sizeof(float));
+  state->write(&toSaveDecorrelate, sizeof(int32));
+  state->write(&toSaveReservedCapture, sizeof(int32));
+  state->write(&toSaveBusMode, sizeof(int32));
+  state->write(&toSaveNearField, sizeof(int32));
+  state->write(&toSaveReferenceRadius, sizeof(float));
+  state->write(&toSaveReflections, sizeof(int32));
+  state->write(&toSaveRoomLength, sizeof(float));
+  state->write(&toSaveRoomWidth, sizeof(float));
+  state->write(&toSaveRoomHeight, sizeof(float));
+  state->write(&toSaveWallReflection, sizeof(float));
+  state->write(&toSaveDistanceModel, sizeof(int32));
 
   return kResultOk;
 }
@@ -31,6 +31,16 @@
 #include "public.sdk/source/vst/vstaudioeffect.h"
 #include "Encoder.h"
 #include "Ramp.h"
+#include "OrderBudget.h"
+#include "DelayLine.h"
+#include "OnePole.h"
+#include "SpreadTable.h"
+#include "Decorrelator.h"
+#include "CaptureWriter.h"
+#include "SceneBus.h"
+#include "NearFieldFilter.h"
+#include "ImageSourceModel.h"
+#include <atomic>
 
 namespace Steinberg {
 namespace Vst {
@@ -39,23 +49,88 @@ namespace Vst {
 class ambiEncoderProcessor: public AudioEffect {
 public:
   ambiEncoderProcessor ();
+  ~ambiEncoderProcessor ();
   static FUnknown* createInstance(void*) {
     return (IAudioProcessor*) new ambiEncoderProcessor();
   }
   tresult PLUGIN_API initialize(FUnknown* context) SMTG_OVERRIDE;
+  tresult PLUGIN_API terminate() SMTG_OVERRIDE;
   tresult PLUGIN_API setBusArrangements(SpeakerArrangement* inputs, int32 numIns, SpeakerArrangement* outputs, int32 numOuts) SMTG_OVERRIDE;
   tresult PLUGIN_API setActive(TBool state) SMTG_OVERRIDE;
   tresult PLUGIN_API process(ProcessData& data) SMTG_OVERRIDE;
   tresult PLUGIN_API setState(IBStream* state) SMTG_OVERRIDE;
   tresult PLUGIN_API getState(IBStream* state) SMTG_OVERRIDE;
+  tresult PLUGIN_API notify(IMessage* message) SMTG_OVERRIDE;
+  uint32 PLUGIN_API getLatencySamples() SMTG_OVERRIDE;
 
 protected:
+  void armCapture();
+  void disarmCapture();
+  void applyBusMode();
+  void releaseBus();
   bool bypass;
+  bool distanceModel;
+  bool decorrelate;
+  bool capture;
+  bool nearField;
+  bool reflections;
   ParamValue theta;
   ParamValue phi;
+  ParamValue priority;
+  ParamValue distance;
+  ParamValue spread;
+  ParamValue referenceRadius;
+  ParamValue roomLength;
+  ParamValue roomWidth;
+  ParamValue roomHeight;
+  ParamValue wallReflection;
   Encoder* encoder;
   Ramp* thetaSmoother;
   Ramp* phiSmoother;
+  Ramp* orderSmoothers[Encoder::MAX_ORDER];
+  double orderGains[Encoder::MAX_ORDER + 1];
+  int32 budgetSlot;
+  uint32 busOrder;
+  Ramp* distanceSmoother;
+  Ramp* distanceModelSmoother;
+  double distanceModelGain;
+  DelayLine* delayLine;
+  OnePole* airAbsorption;
+  double* delayTimes;
+  double* distanceGains;
+  double* sourceSamples;
+  int32 maxBlockSize;
+  Ramp* spreadSmoother;
+  SpreadTable* spreadTable;
+  Decorrelator* decorrelators[Encoder::MAX_CHANNELS - 1];
+  double diffuseCoefficients[Encoder::MAX_CHANNELS];
+  double spreadWeights[Encoder::MAX_ORDER + 1];
+  double diffuseWeights[Encoder::MAX_ORDER + 1];
+  double previousSpread;
+  Ramp* decorrelateSmoother;
+  double decorrelateGain;
+  std::atomic<CaptureWriter*> captureWriter;
+  std::atomic<bool> isPushing;
+  int32 activeChannels;
+  uint32 reportedOverruns;
+  bool reportedCapturing;
+  int32 busMode;
+  std::atomic<int32> effectiveBusMode;
+  std::atomic<int32> busSlot;
+  std::atomic<bool> isPublishing;
+  bool isCollector;
+  int64 busTime;
+  NearFieldFilter* nearFieldFilter;
+  Ramp* nearFieldSmoother;
+  double nearFieldGain;
+  ImageSourceModel* imageSources;
+  double reflectionCoefficients[ImageSourceModel::MAX_REFLECTIONS][Encoder::MAX_CHANNELS];
+  double targetReflectionCoefficients[ImageSourceModel::MAX_REFLECTIONS][Encoder::MAX_CHANNELS];
+  double reflectionDelays[ImageSourceModel::MAX_REFLECTIONS];
+  double reflectionGains[ImageSourceModel::MAX_REFLECTIONS];
+  double* reflectionSamples;
+  double* weightedReflectionSamples;
+  double* orderGainSamples[Encoder::MAX_ORDER];
 };
 
 } // namespace Vst